@@ -0,0 +1,188 @@
+#include "actorscheduler.h"
+
+#ifdef HAS_COROUTINE_ACTORS
+
+#include <algorithm>
+#include <chrono>
+
+// Garde-fou du sommeil d'un thread du pool sans échéance : il est réveillé par la sonnette en temps normal
+static constexpr unsigned IDLE_WAIT_US = 100000;
+
+std::atomic<std::size_t> ActorScheduler::frameBytes{0};
+
+void* ActorTask::promise_type::operator new(std::size_t size) {
+    ActorScheduler::frameBytes.fetch_add(size, std::memory_order_relaxed);
+    return ::operator new(size);
+}
+
+void ActorTask::promise_type::operator delete(void* frame, std::size_t size) {
+    ActorScheduler::frameBytes.fetch_sub(size, std::memory_order_relaxed);
+    ::operator delete(frame);
+}
+
+void ActorTask::promise_type::FinalAwaiter::await_suspend(std::coroutine_handle<promise_type> routine) noexcept {
+    ActorScheduler* scheduler = routine.promise().scheduler;
+    routine.destroy();
+    scheduler->finished(routine);
+}
+
+ActorScheduler::ActorScheduler(int nbThreads) : nbThreads(std::max(nbThreads, 1)) {}
+
+ActorScheduler::~ActorScheduler() {
+    requestStop();
+    if (!workers.empty()) {
+        wait();
+    }
+
+    // Routines jamais reprises (pool non lancé) : leurs trames sont libérées ici
+    for (std::coroutine_handle<> routine : ready) {
+        routine.destroy();
+    }
+    for (; !timers.empty(); timers.pop()) {
+        timers.top().routine.destroy();
+    }
+    for (auto& eventWaiters : waiters) {
+        for (Waiter& waiter : eventWaiters.second) {
+            waiter.routine.destroy();
+        }
+    }
+}
+
+std::int64_t ActorScheduler::now() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void ActorScheduler::spawn(ActorTask task) {
+    auto routine = task.release();
+    routine.promise().scheduler = this;
+    live.fetch_add(1);
+
+    mutex.lock();
+    ready.push_back(routine);
+    mutex.unlock();
+    work.ring();
+}
+
+void ActorScheduler::start() {
+    for (int i = 0; i < nbThreads; ++i) {
+        workers.emplace_back(std::make_unique<PcoThread>(&ActorScheduler::workerRoutine, this));
+    }
+}
+
+void ActorScheduler::wait() {
+    for (auto& worker : workers) {
+        worker->join();
+    }
+    workers.clear();
+}
+
+void ActorScheduler::finished(std::coroutine_handle<>) {
+    // La dernière routine terminée réveille les threads du pool, qui peuvent alors s'arrêter
+    if (live.fetch_sub(1) == 1) {
+        work.ring();
+    }
+}
+
+void ActorScheduler::resumeAfter(std::coroutine_handle<> routine, unsigned micros) {
+    mutex.lock();
+    if (micros == 0) {
+        ready.push_back(routine);
+    } else {
+        timers.push(Timer{now() + micros, nbTimers++, routine});
+    }
+    mutex.unlock();
+    work.ring();
+}
+
+void ActorScheduler::resumeWhen(std::coroutine_handle<> routine, const ActorEvent& event, std::function<bool()> condition) {
+    // Réévaluée sous le verrou : un notify passé entre await_ready et ce dépôt n'est pas perdu
+    mutex.lock();
+    bool satisfied = condition();
+    if (satisfied) {
+        ready.push_back(routine);
+    } else {
+        waiters[&event].push_back(Waiter{routine, std::move(condition)});
+    }
+    mutex.unlock();
+    if (satisfied) {
+        work.ring();
+    }
+}
+
+bool ActorScheduler::resumeSatisfied(std::vector<Waiter>& eventWaiters) {
+    auto satisfied = std::stable_partition(eventWaiters.begin(), eventWaiters.end(),
+                                           [](const Waiter& waiter) { return !waiter.condition(); });
+    bool resumed = satisfied != eventWaiters.end();
+    for (auto it = satisfied; it != eventWaiters.end(); ++it) {
+        ready.push_back(it->routine);
+    }
+    eventWaiters.erase(satisfied, eventWaiters.end());
+    return resumed;
+}
+
+void ActorScheduler::notify(const ActorEvent& event) {
+    mutex.lock();
+    bool resumed = false;
+    auto it = waiters.find(&event);
+    if (it != waiters.end()) {
+        resumed = resumeSatisfied(it->second);
+        if (it->second.empty()) {
+            waiters.erase(it);
+        }
+    }
+    mutex.unlock();
+    if (resumed) {
+        work.ring();
+    }
+}
+
+void ActorScheduler::requestStop() {
+    stop.store(true);
+
+    mutex.lock();
+    bool resumed = false;
+    for (auto it = waiters.begin(); it != waiters.end();) {
+        resumed |= resumeSatisfied(it->second);
+        it = it->second.empty() ? waiters.erase(it) : std::next(it);
+    }
+    mutex.unlock();
+    if (resumed) {
+        work.ring();
+    }
+}
+
+std::int64_t ActorScheduler::wakeUp() {
+    std::int64_t current = now();
+
+    while (!timers.empty() && timers.top().deadline <= current) {
+        ready.push_back(timers.top().routine);
+        timers.pop();
+    }
+    return timers.empty() ? -1 : std::max<std::int64_t>(timers.top().deadline - current, 1);
+}
+
+void ActorScheduler::workerRoutine() {
+    for (;;) {
+        mutex.lock();
+        std::int64_t delay = wakeUp();
+        if (!ready.empty()) {
+            std::coroutine_handle<> routine = ready.front();
+            ready.pop_front();
+            mutex.unlock();
+
+            // La routine peut être reprise par un autre thread dès sa prochaine suspension : on ne la touche plus
+            routine.resume();
+            continue;
+        }
+        // Sonnerie lue sous le verrou : une routine rendue prête ou une échéance ajoutée ensuite réveille aussitôt
+        std::uint32_t seen = work.sequence();
+        mutex.unlock();
+
+        if (live.load() == 0) {
+            return;
+        }
+        work.wait(seen, delay < 0 ? IDLE_WAIT_US : unsigned(std::min<std::int64_t>(delay, IDLE_WAIT_US)));
+    }
+}
+
+#endif // HAS_COROUTINE_ACTORS
@@ -0,0 +1,227 @@
+#ifndef ACTORSCHEDULER_H
+#define ACTORSCHEDULER_H
+
+// Les routines en coroutines demandent un compilateur C++20 (option CMake PCO_COROUTINES) ;
+// sans elles, les acteurs gardent chacun leur thread
+#if defined(__cpp_impl_coroutine) && __has_include(<coroutine>)
+#define HAS_COROUTINE_ACTORS 1
+#endif
+
+#ifdef HAS_COROUTINE_ACTORS
+
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include <pcosynchro/pcomutex.h>
+#include <pcosynchro/pcothread.h>
+
+#include "shmring.h"
+
+class ActorScheduler;
+
+/**
+ * @brief Source d'événements attendue par ActorScheduler::until et signalée par ActorScheduler::notify
+ *        (kit prêt, fin d'un médecin...). Seule son adresse compte : elle n'a pas d'état.
+ */
+struct ActorEvent {};
+
+/**
+ * @brief Routine d'acteur écrite en coroutine, confiée à un ActorScheduler (cf. spawn).
+ *        La coroutine démarre suspendue ; son état (variables locales comprises) tient dans une trame allouée
+ *        sur le tas, de quelques centaines d'octets, au lieu de la pile d'un thread.
+ */
+class ActorTask {
+public:
+    struct promise_type {
+        // La routine terminée se détruit elle-même : le thread qui l'a reprise ne touche plus sa trame
+        struct FinalAwaiter {
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<promise_type> routine) noexcept;
+            void await_resume() const noexcept {}
+        };
+
+        ActorTask get_return_object() { return ActorTask(std::coroutine_handle<promise_type>::from_promise(*this)); }
+        std::suspend_always initial_suspend() noexcept { return {}; }
+        FinalAwaiter final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+
+        // Trames comptées : cf. ActorScheduler::getFrameBytes
+        static void* operator new(std::size_t size);
+        static void operator delete(void* frame, std::size_t size);
+
+        ActorScheduler* scheduler = nullptr;
+    };
+
+    ActorTask(ActorTask&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+    ActorTask(const ActorTask&) = delete;
+    ~ActorTask() {
+        if (handle) {
+            handle.destroy();
+        }
+    }
+
+    std::coroutine_handle<promise_type> release() { return std::exchange(handle, {}); }
+
+private:
+    explicit ActorTask(std::coroutine_handle<promise_type> handle) : handle(handle) {}
+
+    std::coroutine_handle<promise_type> handle;
+};
+
+/**
+ * @brief Ordonnanceur de routines d'acteurs sur un nombre fixe de threads.
+ *        Une routine rend son thread à chaque co_await (attente simulée, condition) ; n'importe quel thread du pool
+ *        la reprend ensuite. Les appels send/request restent directs : ils ne suspendent pas la routine,
+ *        le coursier des fiches patients (local au thread) reste donc valable pendant une transaction.
+ */
+class ActorScheduler {
+public:
+    explicit ActorScheduler(int nbThreads);
+    ~ActorScheduler();
+
+    ActorScheduler(const ActorScheduler&) = delete;
+    ActorScheduler& operator=(const ActorScheduler&) = delete;
+
+    /**
+     * @brief spawn
+     * Ajoute une routine prête. Peut être appelée depuis une routine en cours.
+     */
+    void spawn(ActorTask task);
+
+    /**
+     * @brief start
+     * Lance les threads du pool.
+     */
+    void start();
+
+    /**
+     * @brief requestStop
+     * Demande l'arrêt : les routines le voient avec stopRequested() et se terminent d'elles-mêmes.
+     * Toutes les conditions attendues sont réévaluées une dernière fois, elles peuvent dépendre de l'arrêt.
+     */
+    void requestStop();
+    bool stopRequested() const { return stop.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief wait
+     * Attend la fin de toutes les routines, puis celle des threads du pool.
+     */
+    void wait();
+
+    std::size_t getNbActors() const { return live.load(); }
+
+    /**
+     * @brief getFrameBytes
+     * @return La mémoire occupée par les trames des coroutines d'acteurs encore en vie, tous ordonnanceurs confondus
+     */
+    static std::size_t getFrameBytes() { return frameBytes.load(); }
+
+    struct Sleep {
+        ActorScheduler& scheduler;
+        unsigned micros;
+
+        bool await_ready() const noexcept { return false; }
+        void await_suspend(std::coroutine_handle<> routine) { scheduler.resumeAfter(routine, micros); }
+        void await_resume() const noexcept {}
+    };
+
+    struct Until {
+        ActorScheduler& scheduler;
+        const ActorEvent& event;
+        std::function<bool()> condition;
+
+        bool await_ready() { return condition(); }
+        void await_suspend(std::coroutine_handle<> routine) { scheduler.resumeWhen(routine, event, std::move(condition)); }
+        void await_resume() const noexcept {}
+    };
+
+    /**
+     * @brief sleep
+     * co_await : attente simulée de micros µs, sans occuper de thread (0 : simple passage de tour).
+     */
+    Sleep sleep(unsigned micros) { return Sleep{*this, micros}; }
+
+    /**
+     * @brief until
+     * co_await : attend que la condition soit vraie (stock disponible, traitements terminés...).
+     *        La condition n'est réévaluée qu'à chaque notify(event), et à l'arrêt : qui la rend vraie doit ensuite
+     *        signaler l'événement. Elle est évaluée avec le verrou interne du pool : elle ne doit lire que des valeurs
+     *        atomiques, sans prendre de verrou.
+     */
+    Until until(const ActorEvent& event, std::function<bool()> condition) { return Until{*this, event, std::move(condition)}; }
+
+    /**
+     * @brief notify
+     * Réévalue les conditions des seules routines qui attendent cet événement et reprend celles qui sont vraies.
+     */
+    void notify(const ActorEvent& event);
+
+private:
+    friend struct ActorTask::promise_type;
+
+    struct Timer {
+        std::int64_t deadline;
+        std::uint64_t sequence; // Départage les échéances égales : ordre d'arrivée
+        std::coroutine_handle<> routine;
+
+        bool operator>(const Timer& other) const {
+            return deadline != other.deadline ? deadline > other.deadline : sequence > other.sequence;
+        }
+    };
+
+    struct Waiter {
+        std::coroutine_handle<> routine;
+        std::function<bool()> condition;
+    };
+
+    void finished(std::coroutine_handle<> routine);
+    void resumeAfter(std::coroutine_handle<> routine, unsigned micros);
+    void resumeWhen(std::coroutine_handle<> routine, const ActorEvent& event, std::function<bool()> condition);
+    void workerRoutine();
+
+    /**
+     * @brief Reprend les routines d'une liste d'attente dont la condition est vraie. À appeler avec le mutex verrouillé.
+     * @return true si au moins une routine est devenue prête
+     */
+    bool resumeSatisfied(std::vector<Waiter>& eventWaiters);
+
+    /**
+     * @brief Rend prêtes les routines dont l'échéance est passée. À appeler avec le mutex verrouillé.
+     * @return Le délai (µs) avant la prochaine échéance, -1 sans échéance
+     */
+    std::int64_t wakeUp();
+
+    static std::int64_t now();
+
+    const int nbThreads;
+    std::vector<std::unique_ptr<PcoThread>> workers;
+
+    PcoMutex mutex;
+    std::deque<std::coroutine_handle<>> ready;
+    std::priority_queue<Timer, std::vector<Timer>, std::greater<Timer>> timers;
+    std::unordered_map<const ActorEvent*, std::vector<Waiter>> waiters; // Routines en attente, par événement
+    std::uint64_t nbTimers = 0;
+
+    // Sonnée à chaque routine rendue prête, échéance ajoutée ou fin de la dernière routine : les threads du pool
+    // y dorment jusqu'à la prochaine échéance au lieu de sonder
+    ShmDoorbell work{};
+
+    std::atomic<bool> stop{false};
+    std::atomic<std::size_t> live{0};
+
+    static std::atomic<std::size_t> frameBytes;
+};
+
+#endif // HAS_COROUTINE_ACTORS
+
+#endif // ACTORSCHEDULER_H
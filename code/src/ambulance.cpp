@@ -2,10 +2,10 @@
 #include "costs.h"
 #include <pcosynchro/pcothread.h>
 
-IWindowInterface* Ambulance::interface = nullptr;
-
-Ambulance::Ambulance(int uniqueId, int fund, std::vector<ItemType> resourcesSupplied, std::map<ItemType, int> initialStocks)
-    : Seller(fund, uniqueId), resourcesSupplied(resourcesSupplied), nbTransfer(0)
+Ambulance::Ambulance(int uniqueId, int fund, std::vector<ItemType> resourcesSupplied, std::map<ItemType, int> initialStocks,
+                     IWindowInterface* windowInterface)
+    : Seller(fund, uniqueId, windowInterface), resourcesSupplied(resourcesSupplied),
+      selection(HospitalSelection::PowerOfTwoChoices), nbTransfer(0), nextHospital(0), nbRejected(0)
 {
     interface->consoleAppendText(uniqueId, QString("Ambulance Created"));
 
@@ -20,16 +20,84 @@ Ambulance::Ambulance(int uniqueId, int fund, std::vector<ItemType> resourcesSupp
     interface->updateFund(uniqueId, fund);
 }
 
+bool Ambulance::isAdmissible(size_t idx, int qty, int bill) const {
+    // Sans indication (hôpital d'un autre type), on laisse l'hôpital décider lui-même
+    return !hospitalHints[idx] || hospitalHints[idx]->canProbablyAdmit(qty, bill);
+}
+
+int Ambulance::freeBeds(size_t idx) const {
+    return hospitalHints[idx] ? hospitalHints[idx]->getFreeBedsHint() : estimatedFreeBeds[idx];
+}
+
+int Ambulance::chooseHospital(int qty, int bill) {
+    size_t n = hospitals.size();
+    if (n == 0) {
+        return -1;
+    }
+
+    switch (selection) {
+        case HospitalSelection::Random:
+            return int(rng() % n);
+
+        case HospitalSelection::PowerOfTwoChoices: {
+            size_t a = rng() % n;
+            size_t b = n > 1 ? (a + 1 + rng() % (n - 1)) % n : a;
+            size_t best = freeBeds(b) > freeBeds(a) ? b : a;
+            return isAdmissible(best, qty, bill) ? int(best) : -1;
+        }
+
+        case HospitalSelection::LeastLoaded: {
+            int best = -1;
+            int bestFree = -1;
+            for (size_t i = 0; i < n; ++i) {
+                if (isAdmissible(i, qty, bill) && freeBeds(i) > bestFree) {
+                    best = int(i);
+                    bestFree = freeBeds(i);
+                }
+            }
+            return best;
+        }
+
+        case HospitalSelection::RoundRobin:
+            for (size_t k = 0; k < n; ++k) {
+                size_t i = (nextHospital + k) % n;
+                if (isAdmissible(i, qty, bill)) {
+                    nextHospital = (i + 1) % n;
+                    return int(i);
+                }
+            }
+            return -1;
+    }
+    return -1;
+}
+
 void Ambulance::sendPatient(){
     int qty = 1;
-    auto h = chooseRandomSeller(hospitals);
+    int cost = getCostPerUnit(ItemType::PatientSick);
+    int idx = chooseHospital(qty, cost);
+    if (idx < 0) {
+        // Aucun hôpital ne semble pouvoir accueillir le patient : inutile de tenter l'envoi
+        return;
+    }
+    Seller* h = hospitals[idx];
     mutex.lock();
     if(stocks.at(ItemType::PatientSick)) {
-        int bill = h->send(ItemType::PatientSick, qty, getCostPerUnit(ItemType::PatientSick));
+        if (tracker) {
+            tracker->handOver(sickRecords, qty);
+        }
+        int bill = trade(h, OrderKind::Send, ItemType::PatientSick, qty, cost);
+        if (!hospitalHints[idx]) {
+            estimatedFreeBeds[idx] = bill ? 1 : 0;
+        }
         if(bill) {
             stocks.at(ItemType::PatientSick)--;
             nbTransfer++;
             money += bill;
+        } else {
+            nbRejected++;
+        }
+        if (tracker) {
+            tracker->takeBack(sickRecords);
         }
     }
     mutex.unlock();
@@ -39,10 +107,32 @@ void Ambulance::run() {
     interface->consoleAppendText(uniqueId, "[START] Ambulance routine");
 
     while (!PcoThread::thisThread()->stopRequested()) {
+        {
+            ReplayStep step(replay, uniqueId);
+            if (!step.proceed()) {
+                break;
+            }
+            sendPatient();
+        }
+
+        interface->simulateWork();
+
+        interface->updateFund(uniqueId, money);
+        interface->updateStock(uniqueId, &stocks);
+    }
 
+    interface->consoleAppendText(uniqueId, "[STOP] Ambulance routine");
+}
+
+#ifdef HAS_COROUTINE_ACTORS
+ActorTask Ambulance::runTask(ActorScheduler& scheduler) {
+    interface->consoleAppendText(uniqueId, "[START] Ambulance routine");
+
+    while (!scheduler.stopRequested()) {
+        // L'envoi se termine avant la suspension : les fiches du coursier restent sur ce thread
         sendPatient();
 
-        interface->simulateWork();
+        co_await scheduler.sleep(interface->workDuration());
 
         interface->updateFund(uniqueId, money);
         interface->updateStock(uniqueId, &stocks);
@@ -50,6 +140,7 @@ void Ambulance::run() {
 
     interface->consoleAppendText(uniqueId, "[STOP] Ambulance routine");
 }
+#endif
 
 std::map<ItemType, int> Ambulance::getItemsForSale() {
     return stocks;
@@ -71,19 +162,34 @@ int Ambulance::getNumberPatients(){
     return stocks[ItemType::PatientSick];
 }
 
-void Ambulance::setInterface(IWindowInterface *windowInterface) {
-    interface = windowInterface;
+int Ambulance::getRejectedAdmissions() {
+    return nbRejected;
 }
 
+void Ambulance::setHospitalSelection(HospitalSelection policy) {
+    selection = policy;
+}
 
-void Ambulance::setHospitals(std::vector<Seller*> hospitals){
+
+void Ambulance::setHospitals(SellerList hospitals){
     this->hospitals = hospitals;
+    hospitalHints.clear();
+    estimatedFreeBeds.assign(hospitals.size(), 1);
+    nextHospital = 0;
 
     for (Seller* hospital : hospitals) {
+        hospitalHints.push_back(dynamic_cast<Hospital*>(hospital));
         interface->setLink(uniqueId, hospital->getUniqueId());
     }
 }
 
+void Ambulance::setPatientTracker(PatientTracker* patientTracker) {
+    Seller::setPatientTracker(patientTracker);
+    if (tracker && stocks.count(ItemType::PatientSick)) {
+        tracker->create(sickRecords, stocks[ItemType::PatientSick]);
+    }
+}
+
 int Ambulance::send(ItemType it, int qty, int bill) {
     return 0;
 }
@@ -7,6 +7,16 @@
 #include "iwindowinterface.h"
 #include "costs.h"
 #include "seller.h"
+#include "hospital.h"
+
+/**
+ * @brief Politique utilisée par une ambulance pour choisir l'hôpital auquel envoyer un patient.
+ *        Random : tirage uniforme, sans tenir compte de l'occupation (comportement historique).
+ *        PowerOfTwoChoices : tire deux hôpitaux et garde celui qui a le plus de lits libres.
+ *        LeastLoaded : parcourt tous les hôpitaux et garde celui qui a le plus de lits libres.
+ *        RoundRobin : tourne sur les hôpitaux en sautant ceux qui semblent pleins ou sans fonds.
+ */
+enum class HospitalSelection { Random, PowerOfTwoChoices, LeastLoaded, RoundRobin };
 
 /**
  * @brief La classe Ambulance représente une ambulance capable de transporter des patients
@@ -21,8 +31,10 @@ public:
      * @param fund Argent initial alloué à l'ambulance
      * @param resourcesSupplied Liste des ressources que cette ambulance peut fournir
      * @param initialStocks Stocks initiaux de ressources disponibles dans l'ambulance
+     * @param windowInterface Interface propre à cette ambulance
      */
-    Ambulance(int uniqueId, int fund, std::vector<ItemType> resourcesSupplied, std::map<ItemType, int> initialStocks);
+    Ambulance(int uniqueId, int fund, std::vector<ItemType> resourcesSupplied, std::map<ItemType, int> initialStocks,
+              IWindowInterface* windowInterface);
 
     /**
      * @brief getItemsForSale
@@ -57,6 +69,14 @@ public:
      */
     void run();
 
+#ifdef HAS_COROUTINE_ACTORS
+    /**
+     * @brief runTask
+     * La boucle de run écrite en coroutine : l'attente entre deux envois ne bloque pas de thread du pool.
+     */
+    ActorTask runTask(ActorScheduler& scheduler);
+#endif
+
     /**
      * @brief getMaterialCost
      * @return Le coût des matériaux nécessaires pour le fonctionnement de l'ambulance.
@@ -71,19 +91,30 @@ public:
 
     int getNumberPatients();
 
+    /**
+     * @brief getRejectedAdmissions
+     * @return Le nombre d'envois refusés par un hôpital (plein ou sans fonds).
+     */
+    int getRejectedAdmissions();
+
+    /**
+     * @brief setHospitalSelection
+     * @param policy La politique de choix de l'hôpital de destination
+     */
+    void setHospitalSelection(HospitalSelection policy);
+
     /**
      * @brief setHospitals
-     * @param hospitals Une liste d'hôpitaux avec lesquels l'ambulance va interagir
+     * @param hospitals Une liste d'hôpitaux avec lesquels l'ambulance va interagir, qui doit survivre à l'ambulance
      * Cette fonction configure les hôpitaux pour lesquels l'ambulance effectuera des transferts de patients.
      */
-    void setHospitals(std::vector<Seller*> hospitals);
+    void setHospitals(SellerList hospitals);
 
     /**
-     * @brief setInterface
-     * @param windowInterface Pointeur vers l'interface graphique utilisée pour afficher les logs et mises à jour
-     * Configure l'interface pour afficher les actions de l'ambulance.
+     * @brief setPatientTracker
+     * Crée aussi les fiches des patients déjà présents dans l'ambulance.
      */
-    static void setInterface(IWindowInterface* windowInterface);
+    void setPatientTracker(PatientTracker* patientTracker) override;
 
     /**
      * @brief getResourcesSupplied
@@ -99,12 +130,43 @@ protected:
      */
     void sendPatient();
 
+    /**
+     * @brief chooseHospital
+     * Choisit l'hôpital de destination selon la politique configurée, à l'aide des indications
+     * d'occupation publiées par les hôpitaux (lues sans verrou).
+     * @param qty Le nombre de patients à envoyer
+     * @param bill Le coût de transfert demandé
+     * @return L'indice de l'hôpital choisi, ou -1 si aucun ne semble pouvoir accueillir le patient.
+     */
+    int chooseHospital(int qty, int bill);
+
+    /**
+     * @brief isAdmissible
+     * @return true si l'hôpital d'indice idx semble pouvoir accueillir qty patients.
+     */
+    bool isAdmissible(size_t idx, int qty, int bill) const;
+
+    /**
+     * @brief freeBeds
+     * @return Le nombre de lits libres publié par l'hôpital d'indice idx, ou estimé d'après le dernier envoi
+     *         pour un hôpital sans indication (hôpital distant d'une autre partition).
+     */
+    int freeBeds(size_t idx) const;
+
     std::vector<ItemType> resourcesSupplied;  // Liste des items que ce fournisseur gère (ressources de l'ambulance)
-    int nbTransfer;  // Nombre total d'items (patients) transférés par l'ambulance
-    static IWindowInterface* interface;  // Interface pour les logs et mises à jour
-    std::vector<Seller*> hospitals;  // Liste des hôpitaux associés à cette ambulance
+    SellerList hospitals;  // Liste des hôpitaux associés à cette ambulance (vue sur la table des liens)
+    std::vector<Hospital*> hospitalHints;  // Mêmes hôpitaux, pour lire leurs indications d'occupation (nullptr si inconnu)
+    // Lits libres estimés des hôpitaux sans indication : 1 tant que le dernier envoi a été accepté, 0 après un refus.
+    // Lus et écrits par le seul thread de l'ambulance
+    std::vector<int> estimatedFreeBeds;
+
+    HospitalSelection selection;  // Politique de choix de l'hôpital
 
-    PcoMutex mutex;
+    // Verrou et compteurs modifiés à chaque envoi, sur leurs propres lignes de cache
+    alignas(CACHE_LINE_SIZE) PcoMutex mutex;
+    int nbTransfer;  // Nombre total d'items (patients) transférés par l'ambulance
+    size_t nextHospital;  // Prochain indice pour la politique RoundRobin
+    int nbRejected;  // Nombre d'envois refusés par les hôpitaux
 };
 
 #endif // AMBULANCE_H
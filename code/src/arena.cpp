@@ -0,0 +1,50 @@
+#include "arena.h"
+#include <algorithm>
+#include <cstdint>
+
+SimulationArena::~SimulationArena() {
+    // Ordre inverse de création : un objet peut encore utiliser ceux créés avant lui pendant sa destruction
+    for (auto it = destructors.rbegin(); it != destructors.rend(); ++it) {
+        it->destroy(it->object);
+    }
+    for (const Block& block : blocks) {
+        ::operator delete(block.data, std::align_val_t(CACHE_LINE_SIZE));
+    }
+}
+
+// Position du premier octet aligné à partir de offset dans le bloc
+static std::size_t alignedOffset(const char* data, std::size_t offset, std::size_t alignment) {
+    std::uintptr_t address = reinterpret_cast<std::uintptr_t>(data) + offset;
+    return offset + (alignment - address % alignment) % alignment;
+}
+
+void* SimulationArena::allocate(std::size_t size, std::size_t alignment) {
+    if (!blocks.empty()) {
+        std::size_t start = alignedOffset(blocks.back().data, offset, alignment);
+        if (start + size <= blocks.back().size) {
+            bytesUsed += start + size - offset;
+            offset = start + size;
+            return blocks.back().data + start;
+        }
+    }
+
+    // Nouveau bloc, plus grand que d'habitude si l'objet ne tient pas dans un bloc standard
+    std::size_t blockSize = std::max<std::size_t>(ARENA_BLOCK_SIZE, size + alignment);
+    char* data = static_cast<char*>(::operator new(blockSize, std::align_val_t(CACHE_LINE_SIZE)));
+    blocks.push_back({data, blockSize});
+
+    std::size_t start = alignedOffset(data, 0, alignment);
+    offset = start + size;
+    bytesUsed += offset;
+    return data + start;
+}
+
+int LinkTable::addRow(const std::vector<Seller*>& row) {
+    targets.insert(targets.end(), row.begin(), row.end());
+    offsets.push_back(targets.size());
+    return getNbRows() - 1;
+}
+
+SellerList LinkTable::row(int index) const {
+    return SellerList(targets.data() + offsets[index], offsets[index + 1] - offsets[index]);
+}
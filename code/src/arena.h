@@ -0,0 +1,94 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "seller.h"
+
+// Taille des blocs de l'arène : un bloc contient plusieurs dizaines de vendeurs
+#ifndef ARENA_BLOCK_SIZE
+#define ARENA_BLOCK_SIZE (64 * 1024)
+#endif
+
+/**
+ * @brief Arène d'une simulation : les entités sont construites les unes à la suite des autres dans de grands
+ *        blocs contigus, et toutes détruites (dans l'ordre inverse de création) avec l'arène.
+ *        Les blocs sont alignés sur une ligne de cache, ce qui respecte l'alignement des vendeurs.
+ */
+class SimulationArena {
+public:
+    SimulationArena() = default;
+    ~SimulationArena();
+
+    SimulationArena(const SimulationArena&) = delete;
+    SimulationArena& operator=(const SimulationArena&) = delete;
+
+    /**
+     * @brief create
+     * Construit un objet dans l'arène. L'objet vit jusqu'à la destruction de l'arène et ne doit pas être libéré avec delete.
+     */
+    template<typename T, typename... Args>
+    T* create(Args&&... args) {
+        T* object = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+        if (!std::is_trivially_destructible<T>::value) {
+            destructors.push_back({object, [](void* p) { static_cast<T*>(p)->~T(); }});
+        }
+        return object;
+    }
+
+    /**
+     * @brief getBytesUsed
+     * @return Le nombre d'octets occupés par les objets (alignement compris)
+     */
+    std::size_t getBytesUsed() const { return bytesUsed; }
+
+private:
+    void* allocate(std::size_t size, std::size_t alignment);
+
+    struct Block {
+        char* data;
+        std::size_t size;
+    };
+
+    std::vector<Block> blocks;
+    std::size_t offset = 0;     // Position libre dans le dernier bloc
+    std::size_t bytesUsed = 0;
+
+    struct Destructor {
+        void* object;
+        void (*destroy)(void*);
+    };
+    std::vector<Destructor> destructors;
+};
+
+/**
+ * @brief Table d'adjacence de la simulation au format CSR : toutes les listes de liens sont rangées bout à bout
+ *        dans un seul tableau, une ligne par liste. Plusieurs entités peuvent partager la même ligne
+ *        (toutes les ambulances voient les mêmes hôpitaux, par exemple).
+ *
+ * Les vues renvoyées par row() pointent dans le tableau : on ajoute d'abord toutes les lignes,
+ * puis on distribue les vues, qui restent valides tant que la table n'est ni modifiée ni détruite.
+ */
+class LinkTable {
+public:
+    /**
+     * @brief addRow
+     * @return L'indice de la nouvelle ligne
+     */
+    int addRow(const std::vector<Seller*>& row);
+
+    SellerList row(int index) const;
+
+    int getNbRows() const { return int(offsets.size()) - 1; }
+    std::size_t getNbLinks() const { return targets.size(); }
+
+private:
+    std::vector<std::size_t> offsets{0};   // Début de chaque ligne, plus la fin de la dernière
+    std::vector<Seller*> targets;
+};
+
+#endif // ARENA_H
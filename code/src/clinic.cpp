@@ -1,37 +1,42 @@
 #include "clinic.h"
 #include "costs.h"
 #include <pcosynchro/pcothread.h>
+#include <algorithm>
+#include <deque>
 #include <iostream>
+#include <memory>
 #include <stdexcept>
 
-IWindowInterface* Clinic::interface = nullptr;
-
-Clinic::Clinic(int uniqueId, int fund, std::vector<ItemType> resourcesNeeded)
-    : Seller(fund, uniqueId), nbTreated(0), resourcesNeeded(resourcesNeeded)
+Clinic::Clinic(int uniqueId, int fund, std::vector<ItemType> resourcesNeeded, IWindowInterface* windowInterface, int nbDoctors)
+    : Seller(fund, uniqueId, windowInterface), resourcesNeeded(resourcesNeeded), nbTreated(0), nbDoctors(std::max(nbDoctors, 1))
 {
     interface->updateFund(uniqueId, fund);
     interface->consoleAppendText(uniqueId, "Factory created");
 
-    for(const auto& item : resourcesNeeded) {
-        mutex.lock();
-        stocks[item] = 0;
-        mutex.unlock();
-    }
+    carried = {ItemType::PatientHealed};
+
+    mutex.lock();
+    publishStocks();
+    mutex.unlock();
 }
 
 bool Clinic::verifyResources() {
     mutex.lock();
-    for (auto item : resourcesNeeded) {
-        if (stocks[item] <= 0) {
-            mutex.unlock();
-            return false;
-        }
-    }
+    bool available = hasResources();
     mutex.unlock();
-    return true;
+    return available;
+}
+
+void Clinic::publishStocks() {
+    for (ItemType item : resourcesNeeded) {
+        stocks[item] = flatStock[itemIndex(item)];
+    }
+    stocks[ItemType::PatientHealed] = flatStock[itemIndex(ItemType::PatientHealed)];
 }
 
 int Clinic::request(ItemType what, int qty){
+    noteCall();
+
     int price = 0;
 
     if (what != ItemType::PatientHealed) {
@@ -42,75 +47,235 @@ int Clinic::request(ItemType what, int qty){
 
     // If enough quantity in stocks and if qty is strictly greater than 0
     // we sell, else returns 0 at the end of function
-    if (qty > 0 && stocks[what] >= qty) {
+    if (qty > 0 && flatStock[itemIndex(what)] >= qty) {
         price = getCostPerUnit(what) * qty;
-        stocks[what] -= qty;
+        flatStock[itemIndex(what)] -= qty;
+        healedHint.store(flatStock[itemIndex(what)], std::memory_order_relaxed);
         money += price;
+        if (tracker) {
+            tracker->handOver(healedRecords, qty);
+        }
     }
     mutex.unlock();
 
     return price;
 }
 
-void Clinic::treatPatient() {
+int Clinic::reserveTreatments() {
     int cost = getEmployeeSalary(getEmployeeThatProduces(ItemType::PatientHealed));
-    bool canTreat = true;
 
+    // Réservation : les ressources et les salaires du lot sont retirés avant le traitement
     mutex.lock();
-    if (!getWaitingPatients() && cost > money) {
+    int batch = std::min({nbDoctors, availableTreatments(), money / cost});
+    if (batch <= 0) {
         mutex.unlock();
-        return;
+        return 0;
     }
+    money -= batch * cost;
+    consumeResources(batch);
+    mutex.unlock();
+    return batch;
+}
 
-    for (ItemType item : resourcesNeeded) {
-        if (stocks[item] <= 0) {
-            canTreat = false;
+int Clinic::treatPatients() {
+    int batch = reserveTreatments();
+    if (!batch) {
+        return 0;
+    }
+
+    // Temps simulant un traitement, les médecins soignent leurs patients en parallèle
+    interface->simulateWork();
+
+    finishTreatments(batch);
+    return batch;
+}
+
+void Clinic::finishTreatments(int count) {
+    // Les fiches des patients en traitement sont restées dans sickRecords
+    mutex.lock();
+    flatStock[itemIndex(ItemType::PatientHealed)] += count;
+    healedHint.store(flatStock[itemIndex(ItemType::PatientHealed)], std::memory_order_relaxed);
+    nbTreated += count;
+    if (tracker) {
+        tracker->advance(sickRecords, healedRecords, PatientStage::Treated, count);
+    }
+    mutex.unlock();
+
+    interface->consoleAppendText(uniqueId, QString("Clinic have healed %1 patient(s)").arg(count));
+}
+
+int Clinic::assembleKits() {
+    int cost = getEmployeeSalary(getEmployeeThatProduces(ItemType::PatientHealed));
+
+    // Au plus un kit d'avance par médecin : le reste du stock reste disponible pour les achats et l'affichage
+    mutex.lock();
+    int count = std::min({nbDoctors - readyKits.load(std::memory_order_relaxed), availableTreatments(), money / cost});
+    if (count > 0) {
+        money -= count * cost;
+        consumeResources(count);
+        readyKits.fetch_add(count, std::memory_order_release);
+    }
+    mutex.unlock();
+
+    for (int i = 0; i < count; ++i) {
+        kitsAssembled.release();
+    }
+    return std::max(count, 0);
+}
+
+bool Clinic::claimKit() {
+    int kits = readyKits.load(std::memory_order_acquire);
+    while (kits > 0) {
+        if (readyKits.compare_exchange_weak(kits, kits - 1, std::memory_order_acquire, std::memory_order_acquire)) {
+            return true;
         }
     }
+    return false;
+}
 
-    if (canTreat) {
-        //Temps simulant un traitement
+int Clinic::returnKits() {
+    int cost = getEmployeeSalary(getEmployeeThatProduces(ItemType::PatientHealed));
+
+    mutex.lock();
+    int count = readyKits.exchange(0, std::memory_order_acquire);
+    money += count * cost;
+    releaseResources(count);
+    mutex.unlock();
+    return count;
+}
+
+void Clinic::doctorRoutine() {
+    while (!PcoThread::thisThread()->stopRequested()) {
+        // Un jeton ne garantit pas le kit (rendu à l'arrêt, ou réclamé hors de cette routine) : on revérifie
+        kitsAssembled.acquire();
+        if (!claimKit()) {
+            continue;
+        }
+
+        // Temps simulant un traitement
         interface->simulateWork();
+        finishTreatments(1);
+    }
+}
 
-        money -= cost;
-        for (ItemType item : resourcesNeeded) {
-            --stocks[item];
+#ifdef HAS_COROUTINE_ACTORS
+ActorTask Clinic::doctorTask(ActorScheduler& scheduler, std::atomic<int>& active, const ActorEvent& changed) {
+    while (!scheduler.stopRequested()) {
+        co_await scheduler.until(changed, [this, &scheduler]() {
+            return readyKits.load(std::memory_order_relaxed) > 0 || scheduler.stopRequested();
+        });
+        if (!claimKit()) {
+            continue;
         }
 
-        ++stocks[ItemType::PatientHealed];
-        ++nbTreated;
+        // Temps simulant un traitement
+        co_await scheduler.sleep(interface->workDuration());
+        finishTreatments(1);
+    }
+    active.fetch_sub(1);
+    scheduler.notify(changed);
+}
+#endif
+
+bool Clinic::reservePurchase(ItemType item, int qty) {
+    int price = getCostPerUnit(item) * qty;
+
+    // On ne demande que ce qu'on peut payer (un patient refusé serait perdu par l'hôpital) : le paiement
+    // est réservé, puis le verrou est rendu pendant l'appel, car le vendeur peut lui-même attendre
+    // le verrou de la clinique (Hospital::transferPatientsFromClinic)
+    mutex.lock();
+    bool affordable = flatStock[itemIndex(item)] <= 0 && money >= price;
+    if (affordable) {
+        money -= price;
     }
+    mutex.unlock();
+    return affordable;
+}
 
+void Clinic::settlePurchase(ItemType item, int qty, int cost) {
+    mutex.lock();
+    money += getCostPerUnit(item) * qty - cost;
+    if (cost) {
+        flatStock[itemIndex(item)] += qty;
+        if (item == ItemType::PatientSick && tracker) {
+            tracker->receive(sickRecords, PatientStage::ClinicTransfer);
+        }
+    }
     mutex.unlock();
-    interface->consoleAppendText(uniqueId, "Clinic have healed a new patient");
+}
+
+bool Clinic::buyFrom(Seller* seller, ItemType item, int qty) {
+    if (!reservePurchase(item, qty)) {
+        return false;
+    }
+    int cost = trade(seller, OrderKind::Request, item, qty);
+    settlePurchase(item, qty, cost);
+    return cost != 0;
+}
+
+Seller* Clinic::chooseCarrier(SellerList sellers, ItemType item) {
+    if (sellers.empty()) {
+        return nullptr;
+    }
+    std::size_t start = rng() % sellers.size();
+    for (std::size_t i = 0; i < sellers.size(); ++i) {
+        Seller* seller = sellers[(start + i) % sellers.size()];
+        if (seller->carries(item)) {
+            return seller;
+        }
+    }
+    return nullptr;
+}
+
+void Clinic::placeOrders() {
+    int qtyToBuy = 1;
+
+    // Un ordre par ressource manquante, tous en vol en même temps
+    std::deque<Order> orders;
+    std::vector<std::future<int>> replies;
+    for (ItemType item : resourcesNeeded) {
+        Seller* seller = chooseCarrier(item == ItemType::PatientSick ? hospitals : suppliers, item);
+        if (!seller || !reservePurchase(item, qtyToBuy)) {
+            continue;
+        }
+        orders.emplace_back(OrderKind::Request, item, qtyToBuy, 0);
+        orders.back().replyBell = &inboxBell;
+        replies.push_back(seller->post(orders.back()));
+    }
+
+    for (std::size_t i = 0; i < orders.size(); ++i) {
+        int cost = awaitReply(replies[i]);
+        PatientTracker::unpack(orders[i].parcel);
+        settlePurchase(orders[i].item, orders[i].qty, cost);
+        if (cost) {
+            interface->consoleAppendText(uniqueId, "Clinic has received a new " + getItemName(orders[i].item));
+        }
+    }
 }
 
 void Clinic::orderResources() {
+    if (hasInbox()) {
+        placeOrders();
+        return;
+    }
+
     int qtyToBuy = 1;
-    int cost = 0;
 
     for (ItemType item : resourcesNeeded) {
         switch (item) {
         case ItemType::PatientSick:
             for (auto hospital : hospitals) {
-                mutex.lock();
-                if ((cost = hospital->request(item, qtyToBuy)) < money && stocks[item] <= 0) {
-                    money -= cost;
-                    stocks[item] += qtyToBuy;
+                if (hospital->carries(item) && buyFrom(hospital, item, qtyToBuy)) {
                     interface->consoleAppendText(uniqueId, "Clinic has gotten a new " + getItemName(item));
                 }
-                mutex.unlock();
             }
             break;
         default:
             for (auto supplier : suppliers) {
-                mutex.lock();
-                if (supplier->getItemsForSale().find(item) != getItemsForSale().end() && (cost = supplier->request(item, qtyToBuy)) < money && stocks[item] <= 0) {
-                    money -= cost;
-                    stocks[item] += qtyToBuy;
+                // Test sans verrou : inutile de bloquer un fournisseur qui ne vend pas cet item
+                if (supplier->carries(item) && buyFrom(supplier, item, qtyToBuy)) {
                     interface->consoleAppendText(uniqueId, "Clinic has bought a new " + getItemName(item));
                 }
-                mutex.unlock();
             }
             break;
         }
@@ -124,24 +289,134 @@ void Clinic::run() {
     }
     interface->consoleAppendText(uniqueId, "[START] Factory routine");
 
+    // Avec des threads de médecins, ils soignent en parallèle et la routine de la clinique achète et prépare
+    // leurs kits. Lancés depuis ce thread, ils héritent de son épinglage (cf. ActorPlacement)
+    std::vector<std::unique_ptr<PcoThread>> doctors;
+    if (doctorThreads) {
+        for (int i = 0; i < nbDoctors; ++i) {
+            doctors.emplace_back(std::make_unique<PcoThread>(&Clinic::doctorRoutine, this));
+        }
+    }
+
     while (!PcoThread::thisThread()->stopRequested()) {
+        serveOrders();
+
+        // Sans threads de médecins, le lot est réservé puis rendu soigné dans deux itérations distinctes :
+        // pendant un enregistrement, l'ordre des transactions reste total sans garder l'itération pendant le traitement
+        int treating = 0;
+        {
+            ReplayStep step(replay, uniqueId);
+            if (!step.proceed()) {
+                break;
+            }
+            if (doctorThreads) {
+                assembleKits();
+                if (!verifyResources()) {
+                    orderResources();
+                }
+            } else if (verifyResources()) {
+                treating = reserveTreatments();
+            } else {
+                orderResources();
+            }
+        }
+
+        if (treating) {
+            // Temps simulant un traitement
+            workServingOrders();
+
+            // Rendus soignés même si le rejeu s'interrompt : ressources et salaires sont déjà retirés
+            ReplayStep step(replay, uniqueId);
+            finishTreatments(treating);
+            if (!step.proceed()) {
+                break;
+            }
+        }
+
+        workServingOrders();
+
+        mutex.lock();
+        publishStocks();
+        mutex.unlock();
+
+        interface->updateFund(uniqueId, money);
+        interface->updateStock(uniqueId, &stocks);
+    }
+
+    // Les traitements en cours se terminent, les kits non réclamés retournent au stock et leurs salaires
+    // à la clinique : getAmountPaidToWorkers ne compte que les patients réellement soignés
+    for (auto& doctor : doctors) {
+        doctor->requestStop();
+    }
+    // Réveille les médecins qui attendent un kit pour qu'ils voient la demande d'arrêt
+    for (std::size_t i = 0; i < doctors.size(); ++i) {
+        kitsAssembled.release();
+    }
+    for (auto& doctor : doctors) {
+        doctor->join();
+    }
+    returnKits();
+    closeInbox();
+
+    interface->consoleAppendText(uniqueId, "[STOP] Factory routine");
+}
 
-        if (verifyResources()) {
-            treatPatient();
+#ifdef HAS_COROUTINE_ACTORS
+ActorTask Clinic::runTask(ActorScheduler& scheduler) {
+    if (hospitals.empty() || suppliers.empty()) {
+        std::cerr << "You have to give to hospitals and suppliers to run a clinic" << std::endl;
+        co_return;
+    }
+    interface->consoleAppendText(uniqueId, "[START] Factory routine");
+
+    int nbDoctorTasks = doctorThreads ? nbDoctors : 0;
+    std::atomic<int> doctors{nbDoctorTasks};
+    ActorEvent doctorsChanged;
+    for (int i = 0; i < nbDoctorTasks; ++i) {
+        scheduler.spawn(doctorTask(scheduler, doctors, doctorsChanged));
+    }
+
+    while (!scheduler.stopRequested()) {
+        // Les achats sont des appels directs, terminés avant la prochaine suspension
+        int treating = 0;
+        if (doctorThreads) {
+            if (assembleKits()) {
+                scheduler.notify(doctorsChanged);
+            }
+            if (!verifyResources()) {
+                orderResources();
+            }
+        } else if (verifyResources()) {
+            treating = reserveTreatments();
         } else {
             orderResources();
         }
-       
-        interface->simulateWork();
+
+        if (treating) {
+            // Temps simulant un traitement
+            co_await scheduler.sleep(interface->workDuration());
+            finishTreatments(treating);
+        }
+
+        co_await scheduler.sleep(interface->workDuration());
+
+        mutex.lock();
+        publishStocks();
+        mutex.unlock();
 
         interface->updateFund(uniqueId, money);
         interface->updateStock(uniqueId, &stocks);
     }
+
+    // Comme dans run : traitements en cours terminés, puis kits non réclamés rendus
+    co_await scheduler.until(doctorsChanged, [&doctors]() { return doctors.load() == 0; });
+    returnKits();
+
     interface->consoleAppendText(uniqueId, "[STOP] Factory routine");
 }
+#endif
 
-
-void Clinic::setHospitalsAndSuppliers(std::vector<Seller*> hospitals, std::vector<Seller*> suppliers) {
+void Clinic::setHospitalsAndSuppliers(SellerList hospitals, SellerList suppliers) {
     this->hospitals = hospitals;
     this->suppliers = suppliers;
 
@@ -158,11 +433,15 @@ int Clinic::getTreatmentCost() {
 }
 
 int Clinic::getWaitingPatients() {
-    return stocks[ItemType::PatientSick];
+    return flatStock[itemIndex(ItemType::PatientSick)];
+}
+
+int Clinic::getHealedHint() const {
+    return healedHint.load(std::memory_order_relaxed);
 }
 
 int Clinic::getNumberPatients(){
-    return stocks[ItemType::PatientSick] + stocks[ItemType::PatientHealed];
+    return flatStock[itemIndex(ItemType::PatientSick)] + flatStock[itemIndex(ItemType::PatientHealed)];
 }
 
 int Clinic::send(ItemType it, int qty, int bill){
@@ -173,20 +452,10 @@ int Clinic::getAmountPaidToWorkers() {
     return nbTreated * getEmployeeSalary(getEmployeeThatProduces(ItemType::PatientHealed));
 }
 
-void Clinic::setInterface(IWindowInterface *windowInterface) {
-    interface = windowInterface;
-}
-
 std::map<ItemType, int> Clinic::getItemsForSale() {
-    return stocks;
+    mutex.lock();
+    publishStocks();
+    std::map<ItemType, int> items = stocks;
+    mutex.unlock();
+    return items;
 }
-
-
-Pulmonology::Pulmonology(int uniqueId, int fund) :
-    Clinic::Clinic(uniqueId, fund, {ItemType::PatientSick, ItemType::Pill, ItemType::Thermometer}) {}
-
-Cardiology::Cardiology(int uniqueId, int fund) :
-    Clinic::Clinic(uniqueId, fund, {ItemType::PatientSick, ItemType::Syringe, ItemType::Stethoscope}) {}
-
-Neurology::Neurology(int uniqueId, int fund) :
-    Clinic::Clinic(uniqueId, fund, {ItemType::PatientSick, ItemType::Pill, ItemType::Scalpel}) {}
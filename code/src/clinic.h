@@ -1,14 +1,18 @@
 #ifndef CLINIC_H
 #define CLINIC_H
 
+#include <algorithm>
 #include <vector>
 
+#include <pcosynchro/pcosemaphore.h>
+
 #include "iwindowinterface.h"
 #include "seller.h"
 
 /**
  * @brief La classe Clinic permet l'implémentation d'une clinique et de ses fonctions
  *        de gestion des patients, héritant de la classe Seller.
+ *        Les ressources nécessaires à un traitement sont fixées à la compilation par SpecializedClinic.
  */
 class Clinic : public Seller
 {
@@ -18,8 +22,10 @@ public:
      * @param uniqueId Identifiant unique de la clinique
      * @param fund Capital initial de la clinique
      * @param resourcesNeeded Liste des ressources nécessaires au fonctionnement de la clinique
+     * @param windowInterface Interface propre à cette clinique
+     * @param nbDoctors Nombre de patients que la clinique peut soigner en même temps
      */
-    Clinic(int uniqueId, int fund, std::vector<ItemType> resourcesNeeded);
+    Clinic(int uniqueId, int fund, std::vector<ItemType> resourcesNeeded, IWindowInterface* windowInterface, int nbDoctors);
 
     /**
      * @brief run
@@ -28,6 +34,22 @@ public:
      */
     void run();
 
+    /**
+     * @brief enableDoctorThreads
+     * Chaque médecin soignera sur son propre thread (ou sa coroutine), avec les kits que la routine de la clinique
+     * prépare. Sinon, la routine soigne elle-même par lots de nbDoctors patients. À appeler avant le lancement des threads.
+     */
+    void enableDoctorThreads() { doctorThreads = true; }
+
+#ifdef HAS_COROUTINE_ACTORS
+    /**
+     * @brief runTask
+     * La routine de run écrite en coroutine ; avec enableDoctorThreads, les médecins sont eux aussi des coroutines
+     * du même ordonnanceur.
+     */
+    ActorTask runTask(ActorScheduler& scheduler);
+#endif
+
     /**
      * @brief getItemsForSale
      * @return Retourne une map représentant les items (patients) disponibles à la clinique,
@@ -69,36 +91,142 @@ public:
     /**
      * @brief setHospitalsAndSuppliers
      * Permet d'affecter plusieurs hôpitaux et fournisseurs à la clinique pour faciliter les échanges.
-     * @param hospitals Vecteur d'hôpitaux avec lesquels la clinique va interagir
-     * @param suppliers Vecteur de fournisseurs avec lesquels la clinique va travailler
+     * @param hospitals Hôpitaux avec lesquels la clinique va interagir (la liste doit survivre à la clinique)
+     * @param suppliers Fournisseurs avec lesquels la clinique va travailler (idem)
      */
-    void setHospitalsAndSuppliers(std::vector<Seller*> hospitals, std::vector<Seller*> suppliers);
+    void setHospitalsAndSuppliers(SellerList hospitals, SellerList suppliers);
 
     int getNumberPatients();
 
+    /**
+     * @brief getHealedHint
+     * @return Le nombre de patients soignés en attente, lu sans verrou (indication, peut être dépassée)
+     */
+    int getHealedHint() const;
+
     /**
      * @brief getAmountPaidToWorkers
      * @return Le montant total payé aux travailleurs de la clinique.
      */
     int getAmountPaidToWorkers();
 
+protected:
     /**
-     * @brief setInterface
-     * @param windowInterface Pointeur vers l'interface graphique utilisée pour afficher les logs et mises à jour
-     * Configure l'interface pour l'affichage des actions de la clinique.
+     * @brief hasResources
+     * @return true si chaque ressource nécessaire au traitement est en stock. À appeler avec le mutex verrouillé.
      */
-    static void setInterface(IWindowInterface* windowInterface);
+    virtual bool hasResources() const = 0;
+
+    /**
+     * @brief availableTreatments
+     * @return Le nombre de traitements que le stock permet, patients compris. À appeler avec le mutex verrouillé.
+     */
+    virtual int availableTreatments() const = 0;
+
+    /**
+     * @brief consumeResources
+     * Retire du stock count unités de chaque ressource nécessaire au traitement. À appeler avec le mutex verrouillé.
+     */
+    virtual void consumeResources(int count) = 0;
+
+    /**
+     * @brief releaseResources
+     * Remet en stock count unités de chaque ressource nécessaire au traitement. À appeler avec le mutex verrouillé.
+     */
+    virtual void releaseResources(int count) = 0;
+
+    /**
+     * @brief reserveTreatments
+     * Retire sous le verrou les ressources et les salaires d'un lot de traitements (première moitié de treatPatients).
+     * @return La taille du lot, 0 si aucun traitement n'est possible
+     */
+    int reserveTreatments();
+
+    /**
+     * @brief treatPatients
+     * Soigne en une fois autant de patients que le stock, les fonds et les médecins le permettent.
+     * Les ressources et les salaires sont réservés sous le verrou, le traitement se fait hors verrou :
+     * les hôpitaux peuvent acheter les patients déjà soignés pendant ce temps.
+     * @return Le nombre de patients soignés
+     */
+    int treatPatients();
+
+    /**
+     * @brief assembleKits
+     * Prépare des kits de traitement pour les médecins : un patient, une unité de chaque ressource et le salaire
+     * du médecin sont retirés sous le verrou. Au plus un kit prêt par médecin ; un médecin en attente est réveillé
+     * pour chaque kit préparé.
+     * @return Le nombre de kits préparés
+     */
+    int assembleKits();
+
+    /**
+     * @brief claimKit
+     * Réserve un kit prêt, sans verrou (compare-and-swap sur le compteur de kits).
+     * @return false si aucun kit n'est prêt
+     */
+    bool claimKit();
+
+    /**
+     * @brief returnKits
+     * Rend au stock et aux fonds les kits qui n'ont pas été réclamés (arrêt de la clinique).
+     * @return Le nombre de kits rendus
+     */
+    int returnKits();
+
+    /**
+     * @brief doctorRoutine
+     * Routine d'un médecin : dort jusqu'à ce qu'un kit soit prêt, le réclame, soigne le patient hors verrou,
+     * puis le remet à la clinique.
+     */
+    void doctorRoutine();
+
+#ifdef HAS_COROUTINE_ACTORS
+    /**
+     * @brief doctorRoutine en coroutine : attend un kit prêt avec co_await au lieu de sonder la clinique
+     * @param active : Médecins encore en vie, attendus par runTask avant de rendre les kits
+     * @param changed : Signalé par runTask quand des kits sont prêts, et par chaque médecin qui s'arrête
+     */
+    ActorTask doctorTask(ActorScheduler& scheduler, std::atomic<int>& active, const ActorEvent& changed);
+#endif
+
+    /**
+     * @brief finishTreatments
+     * Ajoute count patients soignés au stock, leurs ressources ayant déjà été consommées.
+     */
+    void finishTreatments(int count);
+
+    /**
+     * @brief publishStocks
+     * Recopie le stock à plat dans la map stocks lue par l'interface. À appeler avec le mutex verrouillé.
+     */
+    void publishStocks();
 
 private:
-    std::vector<Seller*> suppliers;    // Liste des fournisseurs de ressources nécessaires à la clinique
-    std::vector<Seller*> hospitals;     // Liste des hôpitaux associés à la clinique
+    SellerList suppliers;    // Liste des fournisseurs de ressources nécessaires à la clinique (vue sur la table des liens)
+    SellerList hospitals;    // Liste des hôpitaux associés à la clinique (vue sur la table des liens)
 
     const std::vector<ItemType> resourcesNeeded; // Liste des ressources requises pour le fonctionnement de la clinique
 
-    int nbTreated;                      // Nombre total de patients traités par la clinique
+protected:
+    // Stock, verrou et compteurs modifiés par les hôpitaux, sur leurs propres lignes de cache.
+    // Le stock à plat, indexé par itemIndex, fait foi : la map stocks n'en est qu'une copie pour l'affichage
+    alignas(CACHE_LINE_SIZE) FlatStock flatStock{};
+
+private:
     PcoMutex mutex;
+    int nbTreated;                      // Nombre total de patients traités par la clinique
+
+    const int nbDoctors;                // Nombre de médecins, donc de patients soignés en même temps
+    bool doctorThreads = false;         // Médecins sur leurs propres threads (cf. enableDoctorThreads)
 
-    static IWindowInterface* interface; // Pointeur statique vers l'interface utilisateur pour les logs et mises à jour visuelles
+    // Indication lue sans verrou par les hôpitaux : séparée du mutex et du stock, que chaque détenteur du verrou modifie
+    alignas(CACHE_LINE_SIZE) std::atomic<int> healedHint{0}; // Copie du stock de patients soignés
+
+    // Kits de traitement prêts, réclamés sans verrou par les médecins
+    alignas(CACHE_LINE_SIZE) std::atomic<int> readyKits{0};
+    // Un jeton par kit préparé (et un par médecin à l'arrêt) : les médecins y dorment au lieu de sonder readyKits
+    PcoSemaphore kitsAssembled{0};
 
     /**
      * @brief orderResources
@@ -107,50 +235,86 @@ private:
     void orderResources();
 
     /**
-     * @brief treatPatient
-     * Gère le traitement d'un patient dans la clinique, incluant la vérification des ressources nécessaires.
+     * @brief buyFrom
+     * Achète qty unités d'un item à un vendeur si le stock est épuisé et que la clinique peut payer.
+     * Le verrou de la clinique n'est pas gardé pendant l'appel au vendeur.
+     * @return true si l'achat a eu lieu
      */
-    void treatPatient();
+    bool buyFrom(Seller* seller, ItemType item, int qty);
 
     /**
-     * @brief verifyResources
-     * Vérifie si les ressources nécessaires au traitement des patients sont disponibles.
-     * @return true si les ressources sont suffisantes, false sinon.
+     * @brief reservePurchase
+     * Réserve le paiement d'un achat si le stock de l'item est épuisé et que la clinique peut payer.
+     * @return true si l'achat peut être demandé
      */
-    bool verifyResources();
-};
+    bool reservePurchase(ItemType item, int qty);
 
-class Pulmonology : public Clinic {
-public:
     /**
-     * @brief Constructeur de la spécialisation Pulmonology
-     * Initialise une clinique spécialisée en pneumologie.
-     * @param uniqueId Identifiant unique de la clinique
-     * @param fund Capital initial de la clinique
+     * @brief settlePurchase
+     * Conclut un achat réservé : rend la différence entre le prix réservé et le coût facturé (0 si refusé)
+     * et ajoute les unités reçues au stock.
      */
-    Pulmonology(int uniqueId, int fund);
-};
+    void settlePurchase(ItemType item, int qty, int cost);
 
-class Cardiology : public Clinic {
-public:
     /**
-     * @brief Constructeur de la spécialisation Cardiology
-     * Initialise une clinique spécialisée en cardiologie.
-     * @param uniqueId Identifiant unique de la clinique
-     * @param fund Capital initial de la clinique
+     * @brief chooseCarrier
+     * @return Un vendeur de la liste qui vend l'item, en partant d'une position aléatoire, nullptr si aucun
+     */
+    Seller* chooseCarrier(SellerList sellers, ItemType item);
+
+    /**
+     * @brief placeOrders
+     * Mode boîtes aux lettres : un ordre par ressource manquante, tous déposés avant d'attendre les réponses.
+     */
+    void placeOrders();
+
+    /**
+     * @brief verifyResources
+     * Vérifie si les ressources nécessaires au traitement des patients sont disponibles.
+     * @return true si les ressources sont suffisantes, false sinon.
      */
-    Cardiology(int uniqueId, int fund);
+    bool verifyResources();
 };
 
-class Neurology : public Clinic {
+/**
+ * @brief Clinique spécialisée, dont les ressources nécessaires sont une liste d'items connue à la compilation.
+ *        Les vérifications et les décréments du stock sont déroulés par le compilateur (une opération par item,
+ *        sans boucle ni recherche).
+ */
+template<ItemType... Needed>
+class SpecializedClinic : public Clinic {
 public:
     /**
-     * @brief Constructeur de la spécialisation Neurology
-     * Initialise une clinique spécialisée en neurologie.
+     * @brief Constructeur d'une clinique spécialisée
      * @param uniqueId Identifiant unique de la clinique
      * @param fund Capital initial de la clinique
+     * @param windowInterface Interface propre à cette clinique
+     * @param nbDoctors Nombre de patients soignés en même temps
      */
-    Neurology(int uniqueId, int fund);
+    SpecializedClinic(int uniqueId, int fund, IWindowInterface* windowInterface, int nbDoctors = 1)
+        : Clinic(uniqueId, fund, {Needed...}, windowInterface, nbDoctors) {}
+
+protected:
+    bool hasResources() const override {
+        return ((flatStock[itemIndex(Needed)] > 0) && ...);
+    }
+
+    int availableTreatments() const override {
+        return std::min({flatStock[itemIndex(Needed)]...});
+    }
+
+    void consumeResources(int count) override {
+        ((flatStock[itemIndex(Needed)] -= count), ...);
+    }
+
+    void releaseResources(int count) override {
+        ((flatStock[itemIndex(Needed)] += count), ...);
+    }
 };
 
+// Spécialités : une ligne par clinique, la liste des ressources consommées par un traitement
+using Pulmonology = SpecializedClinic<ItemType::PatientSick, ItemType::Pill, ItemType::Thermometer>;
+using Cardiology = SpecializedClinic<ItemType::PatientSick, ItemType::Syringe, ItemType::Stethoscope>;
+using Neurology = SpecializedClinic<ItemType::PatientSick, ItemType::Pill, ItemType::Scalpel>;
+
 #endif // CLINIC_H
@@ -1,12 +1,12 @@
 #include "hospital.h"
+#include "clinic.h"
 #include "costs.h"
 #include <iostream>
 #include <pcosynchro/pcothread.h>
 
-IWindowInterface* Hospital::interface = nullptr;
-
-Hospital::Hospital(int uniqueId, int fund, int maxBeds)
-    : Seller(fund, uniqueId), maxBeds(maxBeds), currentBeds(0), nbHospitalised(0), nbFree(0)
+Hospital::Hospital(int uniqueId, int fund, int maxBeds, IWindowInterface* windowInterface)
+    : Seller(fund, uniqueId, windowInterface), maxBeds(maxBeds), currentBeds(0), nbHospitalised(0), nbFree(0),
+      iterations(0), freeBedsHint(maxBeds), fundHint(fund)
 {
     interface->updateFund(uniqueId, fund);
     interface->consoleAppendText(uniqueId, "Hospital Created with " + QString::number(maxBeds) + " beds");
@@ -16,9 +16,12 @@ Hospital::Hospital(int uniqueId, int fund, int maxBeds)
     for(const auto& item : initialStocks) {
         stocks[item] = 0;
     }
+    carried = {ItemType::PatientSick};
 }
 
 int Hospital::request(ItemType what, int qty){
+    noteCall();
+
     int ret = 0;
 
     mutex.lock();
@@ -28,6 +31,10 @@ int Hospital::request(ItemType what, int qty){
         int bill = qty * getCostPerUnit(ItemType::PatientSick);
         money += bill;
         ret = bill;  
+        if (tracker) {
+            tracker->handOver(sickRecords, qty);
+        }
+        publishHints();
     }
     mutex.unlock();
 
@@ -43,6 +50,10 @@ void Hospital::freeHealedPatient() {
             currentBeds--;
             nbFree++;
             iterations = 1;
+            if (tracker) {
+                tracker->discharge(healedRecords, 1);
+            }
+            publishHints();
         }
     } else {
         iterations++;
@@ -52,23 +63,43 @@ void Hospital::freeHealedPatient() {
 
 void Hospital::transferPatientsFromClinic() {
 
-    auto cl = chooseRandomSeller(clinics);
+    size_t idx = rng() % clinics.size();
+    auto cl = clinics[idx];
     int qty = 1;
 
-    for(int i = 0; i < cl->getItemsForSale()[ItemType::PatientHealed]; i++) {
+    int salary = qty * getEmployeeSalary(EmployeeType::Nurse);
 
+    // Patients soignés lus sans prendre le verrou de la clinique ; à défaut d'indication
+    // (clinique d'un autre type ou distante), on demande son stock
+    int healed = clinicHints[idx] ? clinicHints[idx]->getHealedHint() : cl->getItemsForSale()[ItemType::PatientHealed];
+
+    for(int i = 0; i < healed; i++) {
+
+        // Le lit et le salaire sont réservés : le verrou n'est pas gardé pendant l'achat à la clinique
         mutex.lock();
-        if(maxBeds >= (currentBeds + qty) && money >= qty * getEmployeeSalary(EmployeeType::Nurse)) {
-            int bill = cl->request(ItemType::PatientHealed, 1);
-            if(bill) {
-                money -= bill + qty * getEmployeeSalary(EmployeeType::Nurse);
-                stocks.at(ItemType::PatientHealed)++;
-                currentBeds++;
-            }
-        } else {
+        if(maxBeds < (currentBeds + qty) || money < salary) {
             mutex.unlock();
             break;
         }
+        currentBeds += qty;
+        money -= salary;
+        publishHints();
+        mutex.unlock();
+
+        int bill = trade(cl, OrderKind::Request, ItemType::PatientHealed, qty);
+
+        mutex.lock();
+        if(bill) {
+            money -= bill;
+            stocks.at(ItemType::PatientHealed) += qty;
+            if (tracker) {
+                tracker->receive(healedRecords, PatientStage::ReturnedToHospital);
+            }
+        } else {
+            currentBeds -= qty;
+            money += salary;
+        }
+        publishHints();
         mutex.unlock();
     }
 
@@ -76,6 +107,8 @@ void Hospital::transferPatientsFromClinic() {
 }
 
 int Hospital::send(ItemType it, int qty, int bill) {
+    noteCall();
+
     int newBill = bill + qty * getEmployeeSalary(EmployeeType::Nurse);
 
     int ret = 0;
@@ -87,6 +120,10 @@ int Hospital::send(ItemType it, int qty, int bill) {
         currentBeds += qty;
         nbHospitalised += qty;
         ret = bill;
+        if (tracker) {
+            tracker->receive(it == ItemType::PatientSick ? sickRecords : healedRecords, PatientStage::HospitalAdmission);
+        }
+        publishHints();
     }
     mutex.unlock();
 
@@ -103,17 +140,63 @@ void Hospital::run()
     interface->consoleAppendText(uniqueId, "[START] Hospital routine");
 
     while (!PcoThread::thisThread()->stopRequested()) {
+        serveOrders();
+        {
+            ReplayStep step(replay, uniqueId);
+            if (!step.proceed()) {
+                break;
+            }
+            transferPatientsFromClinic();
+
+            freeHealedPatient();
+        }
+
+        interface->updateFund(uniqueId, money);
+        interface->updateStock(uniqueId, &stocks);
+        workServingOrders(); // Temps d'attente
+    }
+    closeInbox();
+
+    interface->consoleAppendText(uniqueId, "[STOP] Hospital routine");
+}
+
+#ifdef HAS_COROUTINE_ACTORS
+ActorTask Hospital::runTask(ActorScheduler& scheduler)
+{
+    if (clinics.empty()) {
+        std::cerr << "You have to give clinics to a hospital before launching is routine" << std::endl;
+        co_return;
+    }
+
+    interface->consoleAppendText(uniqueId, "[START] Hospital routine");
+
+    while (!scheduler.stopRequested()) {
         transferPatientsFromClinic();
 
         freeHealedPatient();
 
         interface->updateFund(uniqueId, money);
         interface->updateStock(uniqueId, &stocks);
-        interface->simulateWork(); // Temps d'attente
+        co_await scheduler.sleep(interface->workDuration()); // Temps d'attente
     }
 
     interface->consoleAppendText(uniqueId, "[STOP] Hospital routine");
 }
+#endif
+
+void Hospital::publishHints() {
+    freeBedsHint.store(maxBeds - currentBeds, std::memory_order_relaxed);
+    fundHint.store(money, std::memory_order_relaxed);
+}
+
+int Hospital::getFreeBedsHint() const {
+    return freeBedsHint.load(std::memory_order_relaxed);
+}
+
+bool Hospital::canProbablyAdmit(int qty, int bill) const {
+    return getFreeBedsHint() >= qty &&
+           fundHint.load(std::memory_order_relaxed) >= bill + qty * getEmployeeSalary(EmployeeType::Nurse);
+}
 
 int Hospital::getAmountPaidToWorkers() {
     return nbHospitalised * getEmployeeSalary(EmployeeType::Nurse);
@@ -123,19 +206,29 @@ int Hospital::getNumberPatients(){
     return stocks[ItemType::PatientSick] + stocks[ItemType::PatientHealed] + nbFree;
 }
 
+int Hospital::getMaxBeds() const {
+    return maxBeds;
+}
+
+int Hospital::getDischargedPatients() {
+    mutex.lock();
+    int discharged = nbFree;
+    mutex.unlock();
+    return discharged;
+}
+
 std::map<ItemType, int> Hospital::getItemsForSale()
 {
     return stocks;
 }
 
-void Hospital::setClinics(std::vector<Seller*> clinics){
+void Hospital::setClinics(SellerList clinics){
     this->clinics = clinics;
+    clinicHints.clear();
 
     for (Seller* clinic : clinics) {
+        clinicHints.push_back(dynamic_cast<Clinic*>(clinic));
         interface->setLink(uniqueId, clinic->getUniqueId());
     }
 }
 
-void Hospital::setInterface(IWindowInterface* windowInterface){
-    interface = windowInterface;
-}
@@ -1,12 +1,15 @@
 #ifndef HOSPITAL_H
 #define HOSPITAL_H
 
+#include <atomic>
 #include <vector>
 #include <pcosynchro/pcomutex.h>
 
 #include "iwindowinterface.h"
 #include "seller.h"
 
+class Clinic;
+
 /**
  * @brief The Hospital class
  * Gère un hôpital qui reçoit des patients malades des ambulances et des patients soignés des cliniques.
@@ -20,8 +23,9 @@ public:
      * @param uniqueId L'identifiant unique de l'hôpital
      * @param fund L'argent initial de l'hôpital
      * @param maxBeds Le nombre maximum de lits disponibles à l'hôpital
+     * @param windowInterface Interface propre à cet hôpital
      */
-    Hospital(int uniqueId, int fund, int maxBeds);
+    Hospital(int uniqueId, int fund, int maxBeds, IWindowInterface* windowInterface);
 
     /**
      * @brief run
@@ -30,6 +34,14 @@ public:
      */
     void run();
 
+#ifdef HAS_COROUTINE_ACTORS
+    /**
+     * @brief runTask
+     * La boucle de run écrite en coroutine, pilotée par un ActorScheduler.
+     */
+    ActorTask runTask(ActorScheduler& scheduler);
+#endif
+
     /**
     * @brief getItemsForSale
     * @return Retourne la map des patients présents à l'hôpital, avec la clé étant le type de patient (malade ou soigné) et la valeur la quantité.
@@ -57,25 +69,42 @@ public:
 
     /**
      * @brief setClinics
-     * @param clinics Une liste de cliniques avec lesquelles l'hôpital va interagir
+     * @param clinics Une liste de cliniques avec lesquelles l'hôpital va interagir, qui doit survivre à l'hôpital
      * Cette fonction configure les cliniques avec lesquelles l'hôpital va échanger des patients soignés.
      */
-    void setClinics(std::vector<Seller*> clinics);
+    void setClinics(SellerList clinics);
 
     int getNumberPatients();
 
     /**
-     * @brief getAmountPaidToWorkers
-     * @return Le montant total payé aux travailleurs de l'hôpital.
+     * @brief getFreeBedsHint
+     * @return Une estimation du nombre de lits libres, lue sans prendre le mutex de l'hôpital.
+     *         La valeur peut être légèrement périmée, elle sert uniquement à guider le choix des ambulances.
      */
-    int getAmountPaidToWorkers();
+    int getFreeBedsHint() const;
+
+    int getMaxBeds() const;
+
+    /**
+     * @brief getDischargedPatients
+     * @return Le nombre de patients sortis soignés de l'hôpital.
+     */
+    int getDischargedPatients();
 
     /**
-     * @brief setInterface
-     * @param windowInterface Pointeur vers l'interface graphique utilisée pour l'affichage des logs et mises à jour
-     * Configure l'interface pour afficher les actions de l'hôpital, comme les transferts de patients.
+     * @brief canProbablyAdmit
+     * Indique, sans prendre le mutex, si l'hôpital semble pouvoir accueillir des patients.
+     * @param qty Le nombre de patients à admettre
+     * @param bill Le coût de transfert que l'hôpital devra payer
+     * @return true si les lits libres et les fonds publiés le permettent, false sinon.
      */
-    static void setInterface(IWindowInterface* windowInterface);
+    bool canProbablyAdmit(int qty, int bill) const;
+
+    /**
+     * @brief getAmountPaidToWorkers
+     * @return Le montant total payé aux travailleurs de l'hôpital.
+     */
+    int getAmountPaidToWorkers();
 
 private:
     /**
@@ -94,20 +123,33 @@ private:
 
     void freeHealedPatient();
 
-    std::vector<Seller*> clinics;     // Liste des cliniques liées à l'hôpital, qui renvoient des patients soignés
+    /**
+     * @brief publishHints
+     * Met à jour les indications atomiques (lits libres, fonds) lues par les ambulances.
+     * Doit être appelée avec le mutex verrouillé, après chaque modification de currentBeds ou money.
+     */
+    void publishHints();
+
+    SellerList clinics;     // Liste des cliniques liées à l'hôpital, qui renvoient des patients soignés (vue sur la table des liens)
+    std::vector<Clinic*> clinicHints;  // Mêmes cliniques, pour lire sans verrou leurs patients soignés (nullptr si inconnu)
 
     int maxBeds;        // Nombre maximum de lits disponibles à l'hôpital
+
+    // Verrou et compteurs modifiés par les ambulances et les cliniques, sur leurs propres lignes de cache
+    alignas(CACHE_LINE_SIZE) PcoMutex mutex;
     int currentBeds;    // Nombre actuel de lits occupés, représente le nombre de patients présents
 
     int nbHospitalised; //Nombre de transfert réussi vers l'hôpital (nombre de fois ou un(e) infirmier/infirmière est payé)
 
     int nbFree; // Nombre de personnes qui sont sorties soignées de l'hôpital.
 
-    static IWindowInterface* interface;  // Pointeur statique vers l'interface utilisateur pour les logs et mises à jour visuelles
-
-    PcoMutex mutex;
     int iterations;
 
+    // Indications lues sans verrou par les ambulances : séparées du mutex, pour que leurs lectures
+    // ne fassent pas rebondir la ligne du verrou pendant qu'un autre acteur le tient
+    alignas(CACHE_LINE_SIZE) std::atomic<int> freeBedsHint; // Copie de maxBeds - currentBeds, publiée pour les lectures sans verrou
+    std::atomic<int> fundHint;     // Copie de money, publiée pour les lectures sans verrou
+
 };
 
 #endif // HOSPITAL_H
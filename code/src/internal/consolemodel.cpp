@@ -0,0 +1,82 @@
+#include "consolemodel.h"
+
+ConsoleRing::ConsoleRing(std::size_t capacity) : lines(capacity) {}
+
+bool ConsoleRing::push(unsigned int entity, const QString& text) {
+    if (lines.empty()) {
+        return false;
+    }
+    if (count < lines.size()) {
+        lines[(start + count++) % lines.size()] = Line{entity, text};
+        return false;
+    }
+    lines[start] = Line{entity, text};
+    start = (start + 1) % lines.size();
+    return true;
+}
+
+void ConsoleRing::dropOldest() {
+    if (count == 0) {
+        return;
+    }
+    start = (start + 1) % lines.size();
+    --count;
+}
+
+ConsoleModel::ConsoleModel(unsigned int nbEntities, QObject* parent) :
+    QAbstractListModel(parent), perEntity(nbEntities, ConsoleRing(CONSOLE_LINES_PER_ENTITY)), all(CONSOLE_LINES_ALL) {}
+
+const ConsoleRing& ConsoleModel::shown() const {
+    return filter == ALL_ENTITIES ? all : perEntity[filter];
+}
+
+int ConsoleModel::rowCount(const QModelIndex& parent) const {
+    if (parent.isValid()) {
+        return 0;
+    }
+    return static_cast<int>(shown().size());
+}
+
+QVariant ConsoleModel::data(const QModelIndex& index, int role) const {
+    if (role != Qt::DisplayRole || !index.isValid() || index.row() >= rowCount()) {
+        return QVariant();
+    }
+    const ConsoleRing::Line& line = shown().at(index.row());
+    if (filter == ALL_ENTITIES) {
+        return QString("[%1] %2").arg(line.entity).arg(line.text);
+    }
+    return line.text;
+}
+
+void ConsoleModel::append(unsigned int entity, const QString& text) {
+    if (entity >= perEntity.size()) {
+        return;
+    }
+
+    // Seul le tampon affiché notifie la vue ; l'autre est mis à jour silencieusement
+    for (ConsoleRing* ring : {&perEntity[entity], &all}) {
+        if (ring != &shown()) {
+            ring->push(entity, text);
+            continue;
+        }
+
+        if (ring->full()) {
+            beginRemoveRows(QModelIndex(), 0, 0);
+            ring->dropOldest();
+            endRemoveRows();
+        }
+        const int row = static_cast<int>(ring->size());
+        beginInsertRows(QModelIndex(), row, row);
+        ring->push(entity, text);
+        endInsertRows();
+    }
+}
+
+void ConsoleModel::setFilter(int entity) {
+    if (entity != ALL_ENTITIES && (entity < 0 || entity >= static_cast<int>(perEntity.size()))) {
+        entity = ALL_ENTITIES;
+    }
+    beginResetModel();
+    filter = entity;
+    endResetModel();
+}
@@ -0,0 +1,74 @@
+#ifndef CONSOLEMODEL_H
+#define CONSOLEMODEL_H
+
+#include <QAbstractListModel>
+#include <QString>
+#include <vector>
+
+#define CONSOLE_LINES_PER_ENTITY 500 // Lignes conservées par entité
+#define CONSOLE_LINES_ALL 2000       // Lignes conservées pour la vue de toutes les entités
+
+/**
+ * @brief Tampon circulaire de lignes de console, de capacité fixe.
+ *        Une fois plein, chaque ajout écrase la plus ancienne ligne.
+ */
+class ConsoleRing {
+public:
+    struct Line {
+        unsigned int entity;
+        QString text;
+    };
+
+    explicit ConsoleRing(std::size_t capacity = 0);
+
+    /**
+     * @brief push
+     * @return true si la plus ancienne ligne a été écrasée.
+     */
+    bool push(unsigned int entity, const QString& text);
+
+    /**
+     * @brief dropOldest
+     * Retire la plus ancienne ligne (utile pour notifier la vue avant un ajout dans un tampon plein).
+     */
+    void dropOldest();
+
+    const Line& at(std::size_t i) const { return lines[(start + i) % lines.size()]; }
+    std::size_t size() const { return count; }
+    bool full() const { return count == lines.size(); }
+
+private:
+    std::vector<Line> lines;
+    std::size_t start = 0;
+    std::size_t count = 0;
+};
+
+/**
+ * @brief Modèle des consoles de toutes les entités, affiché dans une seule QListView.
+ *        Chaque entité a son propre tampon circulaire ; le filtre choisit le tampon exposé à la vue
+ *        (ALL_ENTITIES : tampon commun, dans l'ordre d'arrivée).
+ */
+class ConsoleModel : public QAbstractListModel {
+    Q_OBJECT
+public:
+    static constexpr int ALL_ENTITIES = -1;
+
+    ConsoleModel(unsigned int nbEntities, QObject* parent = nullptr);
+
+    int rowCount(const QModelIndex& parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex& index, int role = Qt::DisplayRole) const override;
+
+    void append(unsigned int entity, const QString& text);
+
+public slots:
+    void setFilter(int entity);
+
+private:
+    const ConsoleRing& shown() const;
+
+    std::vector<ConsoleRing> perEntity;
+    ConsoleRing all;
+    int filter = ALL_ENTITIES;
+};
+
+#endif // CONSOLEMODEL_H
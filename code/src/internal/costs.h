@@ -1,16 +1,39 @@
 #ifndef COSTS_H
 #define COSTS_H
 
+// Chaque coût peut être redéfini à la compilation (ex. -DDOCTOR_COST=10), pour comparer
+// plusieurs grilles de coûts avec l'exécutable de balayage (pco_hospital_sweep)
+
+#ifndef SYRINGUE_COST
 #define SYRINGUE_COST 5
+#endif
+#ifndef PILL_COST
 #define PILL_COST 6
+#endif
+#ifndef SCALPEL_COST
 #define SCALPEL_COST 7
+#endif
+#ifndef THERMOMETER_COST
 #define THERMOMETER_COST 5
+#endif
+#ifndef STETHOSCOPE_COST
 #define STETHOSCOPE_COST 3
+#endif
+#ifndef HEALING_COST
 #define HEALING_COST 9
+#endif
+#ifndef TRANSFER_COST
 #define TRANSFER_COST 10
+#endif
 
+#ifndef SUPPLIER_COST
 #define SUPPLIER_COST 4
+#endif
+#ifndef NURSE_COST
 #define NURSE_COST 6
+#endif
+#ifndef DOCTOR_COST
 #define DOCTOR_COST 8
+#endif
 
 #endif // COSTS_H
@@ -1,12 +1,26 @@
 ﻿#include "display.h"
+#include "pixmapcache.h"
+#include <QPair>
+#include <QSet>
+
+#include <algorithm>
 
 constexpr double SCENEWIDTH = 1000.0;
 constexpr double SCENELENGTH = 1500.0;
 constexpr double ELEMENT_WIDTH = 75.0;
 constexpr double ELEMENT_WIDTH_BIG = 150.0;
-
-
-static DisplayView* theDisplay;
+constexpr double MIN_ROW_PITCH = ELEMENT_WIDTH_BIG;  // En dessous, la scène s'allonge au lieu de superposer les entités
+constexpr double MIN_SCREEN_PITCH = 12.0;           // En dessous (en pixels à l'écran), les lignes d'une colonne sont agrégées
+constexpr int FRAME_INTERVAL_MS = 16;               // Les textes sont rafraîchis au plus une fois par image
+constexpr std::size_t LINK_BUNDLE_THRESHOLD = 32;   // Au-delà, les liens d'une catégorie passent par un point commun
+constexpr double TEXT_WIDTH = 60.0;                 // Place réservée aux textes des fonds et des stocks
+constexpr double TEXT_HEIGHT = ELEMENT_WIDTH_BIG / 3 / 2;
+
+// Catégories de liens, dans l'ordre de m_links
+enum LinkKind { ClinicToSupplier, ClinicToHospital, AmbulanceToHospital, HospitalToClinic, NbLinkKinds };
+static const QColor LINK_COLORS[NbLinkKinds] = {
+    QColor(0, 255, 0), QColor(0, 200, 0), QColor(238, 130, 238), QColor(255, 128, 0)
+};
 
 SupplierItem::SupplierItem() = default;
 ClinicItem::ClinicItem() = default;
@@ -15,135 +29,136 @@ ResourceItem::ResourceItem() = default;
 ProductionItem::ProductionItem() = default;
 
 
-void DisplayView::place_resources(int x, int y, int id, std::vector<bool> resources){
-
-    QPixmap fund(QString("images/funds_color.png"));
-    QPixmap _fund = fund.scaledToWidth(ELEMENT_WIDTH / 3);
-    auto fund_item = new ResourceItem();
-
-    int index = -1;
-    int index2 = -3;
-    fund_item->setPixmap(_fund);
-    fund_item->setPos(x, y + -1 * (ELEMENT_WIDTH_BIG / 3));
-    m_scene->addItem(fund_item);
-    
-    // Créer et positionner le texte pour les fonds
-    funds[id] = new QGraphicsSimpleTextItem("Waiting...");
-    funds[id]->setPos(x - 50 + 80, y + (index2 - 1) * (ELEMENT_WIDTH_BIG / 3 / 2) + 55);
-    m_scene->addItem(funds[id]);
-
-    if (resources[0]) {
-        QPixmap petrol(QString("images/patientSick.png"));
-        QPixmap _petrol = petrol.scaledToWidth(ELEMENT_WIDTH / 3);
-        auto petrol_item = new ResourceItem();
-        petrol_item->setPixmap(_petrol);
-        petrol_item->setPos(x + (ELEMENT_WIDTH_BIG), y + index++ * (ELEMENT_WIDTH_BIG / 3 / 2));
-        m_scene->addItem(petrol_item);
-        
-        // Créer et positionner le texte pour les patients malades
-        patientsSick[id] = new QGraphicsSimpleTextItem("Waiting...");
-        patientsSick[id]->setPos(x - 50 + (ELEMENT_WIDTH_BIG) + 80, y + index2++ * (ELEMENT_WIDTH_BIG / 3 / 2) + 50);
-        m_scene->addItem(patientsSick[id]);
-    }
+static constexpr std::uint32_t bit(ItemType item) {
+    return 1u << static_cast<int>(item);
+}
 
-    if (resources[1]) {
-        QPixmap copper(QString("images/patientHealed.png"));
-        QPixmap _copper = copper.scaledToWidth(ELEMENT_WIDTH / 3);
-        auto copper_item = new ResourceItem();
-        copper_item->setPixmap(_copper);
-        copper_item->setPos(x + (ELEMENT_WIDTH_BIG), y + index++ * (ELEMENT_WIDTH_BIG / 3 / 2));
-        m_scene->addItem(copper_item);
-        
-        // Créer et positionner le texte pour les patients guéris
-        patientsHealed[id] = new QGraphicsSimpleTextItem("Waiting...");
-        patientsHealed[id]->setPos(x - 50 + (ELEMENT_WIDTH_BIG) + 80, y + index2++ * (ELEMENT_WIDTH_BIG / 3 / 2) + 50);
-        m_scene->addItem(patientsHealed[id]);
-    }
+static qreal rowPitch(unsigned int count) {
+    return std::max(SCENEWIDTH / count, MIN_ROW_PITCH);
+}
 
-    // Répéter pour les autres ressources
-    if (resources[2]) {
-        QPixmap chip(QString("images/syringe.png"));
-        QPixmap _chip = chip.scaledToWidth(ELEMENT_WIDTH / 3);
-        auto chip_item = new ResourceItem();
-        chip_item->setPixmap(_chip);
-        chip_item->setPos(x + (ELEMENT_WIDTH_BIG), y + index++ * (ELEMENT_WIDTH_BIG / 3 / 2));
-        m_scene->addItem(chip_item);
-        
-        syringes[id] = new QGraphicsSimpleTextItem("Waiting...");
-        syringes[id]->setPos(x - 50 + (ELEMENT_WIDTH_BIG) + 80, y + index2++ * (ELEMENT_WIDTH_BIG / 3 / 2) + 50);
-        m_scene->addItem(syringes[id]);
+EntityColumnItem::EntityColumnItem(qreal x, qreal width, const QPixmap& fundIcon, QColor aggregateColor) :
+    m_x(x), m_width(width), m_fundIcon(fundIcon), m_aggregateColor(aggregateColor), m_rowExtent(0)
+{
+    setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+}
+
+std::size_t EntityColumnItem::addRow(qreal y, const QPixmap& icon, std::vector<QPixmap> resources) {
+    prepareGeometryChange();
+
+    m_rowExtent = std::max({m_rowExtent, qreal(icon.height()), resources.size() * (ELEMENT_WIDTH_BIG / 3 / 2)});
+    std::vector<QString> stocks(resources.size(), "Waiting...");
+    m_rows.push_back({y, icon, std::move(resources), "Waiting...", std::move(stocks)});
+
+    qreal top = m_rows.front().y - ELEMENT_WIDTH_BIG / 3;
+    m_bounds = QRectF(m_x, top, m_width, m_rows.back().y + m_rowExtent - top);
+    return m_rows.size() - 1;
+}
+
+QRectF EntityColumnItem::fundRect(const Row& row) const {
+    return QRectF(m_x + 30, row.y - 45, TEXT_WIDTH, TEXT_HEIGHT);
+}
+
+QRectF EntityColumnItem::stockRect(const Row& row, std::size_t slot) const {
+    return QRectF(m_x + ELEMENT_WIDTH_BIG + 30, row.y - 25 + slot * TEXT_HEIGHT, TEXT_WIDTH, TEXT_HEIGHT);
+}
+
+void EntityColumnItem::setFundText(std::size_t row, const QString& text) {
+    m_rows[row].fund = text;
+    update(fundRect(m_rows[row]));
+}
+
+void EntityColumnItem::setStockText(std::size_t row, std::size_t slot, const QString& text) {
+    m_rows[row].stocks[slot] = text;
+    update(stockRect(m_rows[row], slot));
+}
+
+QRectF EntityColumnItem::boundingRect() const {
+    return m_bounds;
+}
+
+void EntityColumnItem::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) {
+    Q_UNUSED(widget);
+
+    if (m_rows.empty()) {
+        return;
     }
 
-    if (resources[3]) {
-        QPixmap sand(QString("images/pill.png"));
-        QPixmap _sand = sand.scaledToWidth(ELEMENT_WIDTH / 3);
-        auto sand_item = new ResourceItem();
-        sand_item->setPixmap(_sand);
-        sand_item->setPos(x + (ELEMENT_WIDTH_BIG), y + index++ * (ELEMENT_WIDTH_BIG / 3 / 2));
-        m_scene->addItem(sand_item);
-        
-        pills[id] = new QGraphicsSimpleTextItem("Waiting...");
-        pills[id]->setPos(x - 50 + (ELEMENT_WIDTH_BIG) + 80, y + index2++ * (ELEMENT_WIDTH_BIG / 3 / 2) + 50);
-        m_scene->addItem(pills[id]);
+    // Seules les lignes qui intersectent la zone exposée sont parcourues (lignes triées par y)
+    const QRectF exposed = option->exposedRect;
+    auto first = std::lower_bound(m_rows.begin(), m_rows.end(), exposed.top() - m_rowExtent,
+                                  [](const Row& row, qreal y) { return row.y < y; });
+    auto last = std::upper_bound(first, m_rows.end(), exposed.bottom() + ELEMENT_WIDTH_BIG / 3,
+                                 [](qreal y, const Row& row) { return y < row.y; });
+    if (first == last) {
+        return;
     }
 
-    if (resources[4]) {
-        QPixmap robot(QString("images/scalpel.png"));
-        QPixmap _robot = robot.scaledToWidth(ELEMENT_WIDTH / 3);
-        auto robot_item = new ResourceItem();
-        robot_item->setPixmap(_robot);
-        robot_item->setPos(x + (ELEMENT_WIDTH_BIG), y + index++ * (ELEMENT_WIDTH_BIG / 3 / 2));
-        m_scene->addItem(robot_item);
-        
-        scalpels[id] = new QGraphicsSimpleTextItem("Waiting...");
-        scalpels[id]->setPos(x - 50 + (ELEMENT_WIDTH_BIG) + 80, y + index2++ * (ELEMENT_WIDTH_BIG / 3 / 2) + 50);
-        m_scene->addItem(scalpels[id]);
+    const qreal lod = QStyleOptionGraphicsItem::levelOfDetailFromTransform(painter->worldTransform());
+    const qreal pitch = m_rows.size() > 1 ? (m_rows.back().y - m_rows.front().y) / (m_rows.size() - 1) : m_rowExtent;
+    if (pitch * lod < MIN_SCREEN_PITCH) {
+        // Les entités se chevauchent à l'écran : une bande remplace leurs icônes
+        painter->fillRect(QRectF(m_x, first->y, m_width, (last - 1)->y - first->y + m_rowExtent), m_aggregateColor);
+        return;
     }
 
-    if (resources[5]) {
-        QPixmap plastic(QString("images/thermometer.png"));
-        QPixmap _plastic = plastic.scaledToWidth(ELEMENT_WIDTH / 3);
-        auto plastic_item = new ResourceItem();
-        plastic_item->setPixmap(_plastic);
-        plastic_item->setPos(x + (ELEMENT_WIDTH_BIG), y + index++ * (ELEMENT_WIDTH_BIG / 3 / 2));
-        m_scene->addItem(plastic_item);
-        
-        thermometers[id] = new QGraphicsSimpleTextItem("Waiting...");
-        thermometers[id]->setPos(x - 50 + (ELEMENT_WIDTH_BIG) + 80, y + index2++ * (ELEMENT_WIDTH_BIG / 3 / 2) + 50);
-        m_scene->addItem(thermometers[id]);
+    painter->setPen(Qt::black);
+    for (auto row = first; row != last; ++row) {
+        painter->drawPixmap(QPointF(m_x, row->y), row->icon);
+        painter->drawPixmap(QPointF(m_x, row->y - ELEMENT_WIDTH_BIG / 3), m_fundIcon);
+        painter->drawText(fundRect(*row), Qt::AlignLeft | Qt::AlignTop, row->fund);
+
+        qreal y = row->y - ELEMENT_WIDTH_BIG / 3 / 2;
+        for (std::size_t slot = 0; slot < row->resources.size(); ++slot) {
+            painter->drawPixmap(QPointF(m_x + ELEMENT_WIDTH_BIG, y), row->resources[slot]);
+            painter->drawText(stockRect(*row, slot), Qt::AlignLeft | Qt::AlignTop, row->stocks[slot]);
+            y += ELEMENT_WIDTH_BIG / 3 / 2;
+        }
     }
+}
 
-    if (resources[6]) {
-        QPixmap plastic(QString("images/stethoscope.png"));
-        QPixmap _plastic = plastic.scaledToWidth(ELEMENT_WIDTH / 3);
-        auto plastic_item = new ResourceItem();
-        plastic_item->setPixmap(_plastic);
-        plastic_item->setPos(x + (ELEMENT_WIDTH_BIG), y + index++ * (ELEMENT_WIDTH_BIG / 3 / 2));
-        m_scene->addItem(plastic_item);
-        
-        stethoscopes[id] = new QGraphicsSimpleTextItem("Waiting...");
-        stethoscopes[id]->setPos(x - 50 + (ELEMENT_WIDTH_BIG) + 80, y + index2++ * (ELEMENT_WIDTH_BIG / 3 / 2) + 50);
-        m_scene->addItem(stethoscopes[id]);
+void DisplayView::place_resources(EntityColumnItem* column, int x, int y, int id, const QPixmap& icon){
+    std::vector<QPixmap> icons;
+
+    m_entityPos[id] = QPointF(x, y);
+    m_entityHeight[id] = icon.height();
+
+    // Icônes et textes sont dessinés par la colonne : aucun item de la scène par entité
+    for (int i = 0; i < DISPLAYED_ITEM_TYPES; ++i) {
+        if (m_resourceMask[id] & (1u << i)) {
+            icons.push_back(PixmapCache::get(ITEM_CATALOG[i].image, ELEMENT_WIDTH / 3));
+        }
     }
+
+    m_entityColumn[id] = column;
+    m_entityRow[id] = column->addRow(y, icon, std::move(icons));
 }
 
 
 DisplayView::DisplayView(unsigned int nbSuppliers, unsigned int nbClinics, unsigned int nbHospitals, QWidget *parent) :
     QGraphicsView(parent)
 {
-    theDisplay = this;
-
     m_scene = new QGraphicsScene(this);
     createResourceAssociations(nbSuppliers, nbHospitals, nbClinics);
 
-    funds = std::vector<QGraphicsSimpleTextItem*>(nbSuppliers + nbClinics + nbHospitals);
-    syringes = std::vector<QGraphicsSimpleTextItem*>(nbSuppliers + nbClinics + nbHospitals);
-    pills = std::vector<QGraphicsSimpleTextItem*>(nbSuppliers + nbClinics + nbHospitals);
-    scalpels = std::vector<QGraphicsSimpleTextItem*>(nbSuppliers + nbClinics + nbHospitals);
-    thermometers = std::vector<QGraphicsSimpleTextItem*>(nbSuppliers + nbClinics + nbHospitals);
-    stethoscopes = std::vector<QGraphicsSimpleTextItem*>(nbSuppliers + nbClinics + nbHospitals);
-    patientsSick = std::vector<QGraphicsSimpleTextItem*>(nbSuppliers + nbClinics + nbHospitals);
-    patientsHealed = std::vector<QGraphicsSimpleTextItem*>(nbSuppliers + nbClinics + nbHospitals);
+    unsigned int nbEntities = nbSuppliers + nbClinics + nbHospitals;
+    m_entityColumn.assign(nbEntities, nullptr);
+    m_entityRow.assign(nbEntities, 0);
+    m_pendingStock.assign(nbEntities, {});
+    m_shownStock.resize(nbEntities);
+    for (auto& shown : m_shownStock) {
+        shown.fill(NOT_SHOWN);
+    }
+    m_pendingFund.assign(nbEntities, 0);
+    m_shownFund.assign(nbEntities, NOT_SHOWN);
+    m_dirty.assign(nbEntities, false);
+    m_dirtyEntities.reserve(nbEntities);
+
+    m_frameTimer.setSingleShot(true);
+    m_frameTimer.setInterval(FRAME_INTERVAL_MS);
+    connect(&m_frameTimer, &QTimer::timeout, this, &DisplayView::flushUpdates);
+    m_entityPos.resize(nbEntities);
+    m_entityHeight.resize(nbEntities);
 
     this->setRenderHints(QPainter::Antialiasing | QPainter::SmoothPixmapTransform);
     // this->setMinimumHeight(SCENEWIDTH);
@@ -151,189 +166,243 @@ DisplayView::DisplayView(unsigned int nbSuppliers, unsigned int nbClinics, unsig
     this->setScene(m_scene);
     this->setMaximumHeight(SCENEWIDTH);
     this->setMaximumWidth(SCENELENGTH);
+    this->setOptimizationFlag(QGraphicsView::DontAdjustForAntialiasing);
 
+    const QPixmap fundIcon = PixmapCache::get("funds_color", ELEMENT_WIDTH / 3);
+    const qreal columnWidth = ELEMENT_WIDTH_BIG + 30 + TEXT_WIDTH;
+
+    int x = 0 + SCENELENGTH / 6;//QRandomGenerator::system()->bounded(SCENELENGTH / 3);
+    auto suppliersColumn = new EntityColumnItem(x, columnWidth, fundIcon, QColor(238, 130, 238));
     for (unsigned int i = 0; i < nbSuppliers; ++i){
         QString str;
         switch(i % 3){
             case 0:
-                str = "images/ambulance.png";
+                str = "ambulance";
                 break;
             case 1:
-                str = "images/medicalDevice.png";
+                str = "medicalDevice";
                 break;
             case 2:
-                str = "images/pharmacy.png";
+                str = "pharmacy";
                 break;
         }
 
-        QPixmap img(str);
-        QPixmap supplierPixmap;
-        int x = 0 + SCENELENGTH / 6;//QRandomGenerator::system()->bounded(SCENELENGTH / 3);
-        int y = (SCENEWIDTH / nbSuppliers) * i + SCENEWIDTH / nbSuppliers / 2;
-
-        supplierPixmap = img.scaledToWidth(ELEMENT_WIDTH_BIG);
-        auto supplier = new ProductionItem();
-        supplier->setPixmap(supplierPixmap);
-        supplier->setPos(x, y);
-        m_scene->addItem(supplier);
-        m_productItem.push_back(supplier);
-
-        place_resources(x, y, i, resourceAssociations[i]);
+        int y = rowPitch(nbSuppliers) * i + rowPitch(nbSuppliers) / 2;
+        place_resources(suppliersColumn, x, y, i, PixmapCache::get(str, ELEMENT_WIDTH_BIG));
     }
+    m_scene->addItem(suppliersColumn);
 
+    x = (SCENELENGTH / 3) + (SCENELENGTH / 6);
+    auto hospitalsColumn = new EntityColumnItem(x, columnWidth, fundIcon, QColor(255, 128, 0));
     for (unsigned int i = 0; i < nbHospitals; ++i) {
-        QPixmap img(QString("images/hospital.png"));
-        QPixmap hospitalPixmap;
-        int x = (SCENELENGTH / 3) + (SCENELENGTH / 6);
-//        int x = (SCENELENGTH / 3) * 2 + (SCENELENGTH / 6);//QRandomGenerator::system()->bounded(SCENELENGTH / 3);
-        int y = (SCENEWIDTH / nbHospitals) * i + SCENEWIDTH / nbHospitals / 2;
-
-        hospitalPixmap = img.scaledToWidth(ELEMENT_WIDTH_BIG);
-        auto hospital = new ProductionItem();
-        hospital->setPixmap(hospitalPixmap);
-
-        hospital->setPos(x, y);
-        m_scene->addItem(hospital);
-        m_productItem.push_back(hospital);
-
-        place_resources(x, y, i + nbSuppliers, resourceAssociations[i + nbSuppliers]);
+        int y = rowPitch(nbHospitals) * i + rowPitch(nbHospitals) / 2;
+        place_resources(hospitalsColumn, x, y, i + nbSuppliers, PixmapCache::get("hospital", ELEMENT_WIDTH_BIG));
     }
+    m_scene->addItem(hospitalsColumn);
 
+    x = (SCENELENGTH / 3) * 2 + (SCENELENGTH / 6);
+    auto clinicsColumn = new EntityColumnItem(x, columnWidth, fundIcon, QColor(0, 200, 0));
     for (unsigned int i = 0; i < nbClinics; ++i) {
-        QPixmap img(QString("images/clinic.png"));
-        QPixmap clinicPixmap;
-        int x = (SCENELENGTH / 3) * 2 + (SCENELENGTH / 6);
-//        int x = (SCENELENGTH / 3) + (SCENELENGTH / 6);//QRandomGenerator::system()->bounded(SCENELENGTH / 3);
-        int y = (SCENEWIDTH / nbClinics) * i + SCENEWIDTH / nbClinics / 2;
-
-        clinicPixmap = img.scaledToWidth(ELEMENT_WIDTH_BIG);
-        auto clinic = new ProductionItem();
-        clinic->setPixmap(clinicPixmap);
-        clinic->setPos(x, y);
-        m_scene->addItem(clinic);
-        m_productItem.push_back(clinic);
+        int y = rowPitch(nbClinics) * i + rowPitch(nbClinics) / 2;
+        place_resources(clinicsColumn, x, y, i + nbSuppliers + nbHospitals, PixmapCache::get("clinic", ELEMENT_WIDTH_BIG));
+    }
+    m_scene->addItem(clinicsColumn);
 
-        place_resources(x, y, i + nbSuppliers + nbHospitals, resourceAssociations[i + nbHospitals + nbSuppliers]);
+    m_links.resize(NbLinkKinds);
+    for (int kind = 0; kind < NbLinkKinds; ++kind) {
+        QPen pen(LINK_COLORS[kind]);
+        pen.setWidth(2);
+        m_links[kind].item = m_scene->addPath(QPainterPath(), pen);
+    }
+}
 
+void DisplayView::wheelEvent(QWheelEvent* event) {
+    // Ctrl + molette : zoom, pour avoir une vue d'ensemble des grands réseaux
+    if (event->modifiers() & Qt::ControlModifier) {
+        qreal factor = event->angleDelta().y() > 0 ? 1.25 : 0.8;
+        scale(factor, factor);
+        event->accept();
+        return;
     }
+    QGraphicsView::wheelEvent(event);
 }
 
 void DisplayView::createResourceAssociations(unsigned int nbSuppliers, unsigned int nbHospitals, unsigned int nbClinics) {
-    unsigned int totalEntities = nbSuppliers + nbHospitals + nbClinics;
-    resourceAssociations.resize(totalEntities, std::vector<bool>(7, false));
-
+    m_resourceMask.assign(nbSuppliers + nbHospitals + nbClinics, 0);
 
-
-    // Remplissez le vecteur resourceAssociations en fonction du nombre d'entités de chaque type
     for (unsigned int i = 0; i < nbSuppliers; ++i) {
-        std::vector<bool> supplierResources(7, false);
-        if (i % 3 == 0) {
-            supplierResources[0] = true; // Ambulance
-        } else if (i % 3 == 1) {
-            supplierResources[4] = true; // MedicalDevice
-            supplierResources[5] = true;
-            supplierResources[6] = true;
-        } else if (i % 3 == 2) {
-            supplierResources[2] = true; // Pharmacie
-            supplierResources[3] = true;
+        switch (i % 3) {
+        case 0: // Ambulance
+            m_resourceMask[i] = bit(ItemType::PatientSick);
+            break;
+        case 1: // MedicalDevice
+            m_resourceMask[i] = bit(ItemType::Scalpel) | bit(ItemType::Thermometer) | bit(ItemType::Stethoscope);
+            break;
+        case 2: // Pharmacie
+            m_resourceMask[i] = bit(ItemType::Syringe) | bit(ItemType::Pill);
+            break;
         }
-        resourceAssociations[i] = supplierResources;
     }
 
     for (unsigned int i = 0; i < nbHospitals; ++i) {
-        // Pour les grossistes, toutes les ressources sont associées (true)
-        std::vector<bool> hospitalResources(7, false);
-
-        hospitalResources[0] = true;
-        hospitalResources[1] = true;
-
-        resourceAssociations[i+nbSuppliers] = hospitalResources;
+        m_resourceMask[i + nbSuppliers] = bit(ItemType::PatientSick) | bit(ItemType::PatientHealed);
     }
 
+    const ResourceMask patients = bit(ItemType::PatientSick) | bit(ItemType::PatientHealed);
     for (unsigned int i = 0; i < nbClinics; ++i) {
-        std::vector<bool> clinicResources(7, false);
-        if (i % 3 == 0) {
-            clinicResources[0] = true; // Clinic 1
-            clinicResources[1] = true;
-            clinicResources[3] = true;
-            clinicResources[5] = true;
-        } else if (i % 3 == 1) {
-            clinicResources[0] = true; // Clinic 2
-            clinicResources[1] = true; 
-            clinicResources[2] = true;
-            clinicResources[6] = true;
-        } else if (i % 3 == 2) {
-            clinicResources[0] = true; // Clinic 3
-            clinicResources[1] = true; 
-            clinicResources[3] = true;
-            clinicResources[4] = true;
+        ResourceMask& mask = m_resourceMask[i + nbSuppliers + nbHospitals];
+        switch (i % 3) {
+        case 0: // Clinic 1
+            mask = patients | bit(ItemType::Pill) | bit(ItemType::Thermometer);
+            break;
+        case 1: // Clinic 2
+            mask = patients | bit(ItemType::Syringe) | bit(ItemType::Stethoscope);
+            break;
+        case 2: // Clinic 3
+            mask = patients | bit(ItemType::Pill) | bit(ItemType::Scalpel);
+            break;
         }
-        resourceAssociations[i + nbSuppliers + nbHospitals] = clinicResources;
     }
+}
 
+void DisplayView::update_fund(int idx, unsigned fund) {
+    m_pendingFund[idx] = fund;
+    markDirty(idx);
 }
 
-void DisplayView::update_fund(int idx, QString fund) {
-    this->funds[idx]->setText(fund);
+void DisplayView::markDirty(int idx) {
+    if (!m_dirty[idx]) {
+        m_dirty[idx] = true;
+        m_dirtyEntities.push_back(idx);
+    }
+    if (!m_frameTimer.isActive()) {
+        m_frameTimer.start();
+    }
+}
+
+void DisplayView::flushUpdates() {
+    // Un seul passage par image : seuls les textes dont la valeur a changé sont réécrits, chacun invalide
+    // sa zone de la colonne, et la scène regroupe ces zones en un seul rafraîchissement
+    for (int idx : m_dirtyEntities) {
+        m_dirty[idx] = false;
+
+        EntityColumnItem* column = m_entityColumn[idx];
+        if (m_shownFund[idx] != m_pendingFund[idx]) {
+            m_shownFund[idx] = m_pendingFund[idx];
+            column->setFundText(m_entityRow[idx], QString::number(m_pendingFund[idx]));
+        }
+
+        // Les ressources affichées occupent les emplacements de la ligne dans l'ordre des bits du masque
+        const ResourceMask mask = m_resourceMask[idx];
+        std::size_t slot = 0;
+        for (int i = 0; i < DISPLAYED_ITEM_TYPES; ++i) {
+            if (!(mask & (1u << i))) {
+                continue;
+            }
+            if (m_shownStock[idx][i] != m_pendingStock[idx][i]) {
+                m_shownStock[idx][i] = m_pendingStock[idx][i];
+                column->setStockText(m_entityRow[idx], slot, QString::number(m_pendingStock[idx][i]));
+            }
+            ++slot;
+        }
+    }
+    m_dirtyEntities.clear();
+
+    for (LinkCategory& category : m_links) {
+        if (category.dirty) {
+            rebuildLinks(category);
+        }
+    }
 }
 
 void DisplayView::set_link(int from, int to) {
-    QPoint pFrom(m_productItem[from]->pos().x(), m_productItem[from]->pos().y());
-    QPoint pTo(m_productItem[to]->pos().x(), m_productItem[to]->pos().y());
+    QPoint pFrom(m_entityPos[from].x(), m_entityPos[from].y());
+    QPoint pTo(m_entityPos[to].x(), m_entityPos[to].y());
     QLine line;
-    QColor linkColor;
+    LinkKind kind;
 
     if (pFrom.x() >  SCENELENGTH / 2){
         /* Link Clinic -> Hospital and suppliers*/
-        line = QLine(QPoint(pFrom.x(), pFrom.y() + (m_productItem[from]->pixmap().height() / 2)),
-                     QPoint(pTo.x() + ((ELEMENT_WIDTH) * 2) + 50, pTo.y() + (m_productItem[to]->pixmap().height() / 2)));
+        line = QLine(QPoint(pFrom.x(), pFrom.y() + (m_entityHeight[from] / 2)),
+                     QPoint(pTo.x() + ((ELEMENT_WIDTH) * 2) + 50, pTo.y() + (m_entityHeight[to] / 2)));
         
         if(pTo.x() < SCENELENGTH / 2)
-            linkColor = QColor(0, 255, 0);
+            kind = ClinicToSupplier;
         else
-            linkColor = QColor(0, 200, 0);
+            kind = ClinicToHospital;
     } else {
         if (pFrom.x() < SCENELENGTH / 2) {
-            line = QLine(QPoint(pTo.x(), pTo.y() + (m_productItem[from]->pixmap().height()/2)),
-                         QPoint(pFrom.x() + ((ELEMENT_WIDTH)*2) + 50, pFrom.y() + (m_productItem[to]->pixmap().height()/2)));
+            line = QLine(QPoint(pTo.x(), pTo.y() + (m_entityHeight[from]/2)),
+                         QPoint(pFrom.x() + ((ELEMENT_WIDTH)*2) + 50, pFrom.y() + (m_entityHeight[to]/2)));
 
-            linkColor = QColor(238,130,238);
+            kind = AmbulanceToHospital;
         } else {
-            line = QLine(QPoint(pTo.x(), pTo.y() + (m_productItem[from]->pixmap().height() / 2) + 10),
-                     QPoint(pFrom.x() + ((ELEMENT_WIDTH) * 2) + 50, pFrom.y() + (m_productItem[to]->pixmap().height() / 2) + 10));
-            linkColor = QColor(255,128,0);
+            line = QLine(QPoint(pTo.x(), pTo.y() + (m_entityHeight[from] / 2) + 10),
+                     QPoint(pFrom.x() + ((ELEMENT_WIDTH) * 2) + 50, pFrom.y() + (m_entityHeight[to] / 2) + 10));
+            kind = HospitalToClinic;
         }
     }
 
-    QPen pen(linkColor);
-    pen.setWidth(2);
-
-    m_scene->addLine(line, pen);
+    // Le chemin de la catégorie est reconstruit au prochain rafraîchissement
+    m_links[kind].lines.push_back(QLineF(line));
+    m_links[kind].dirty = true;
+    if (!m_frameTimer.isActive()) {
+        m_frameTimer.start();
+    }
 }
 
-void DisplayView::update_stocks(int idx, std::map<ItemType, int>* stocks) {
+void DisplayView::rebuildLinks(LinkCategory& category) {
+    QPainterPath path;
 
-    std::vector<bool> updates = resourceAssociations[idx];
-
-    if(updates[0]){
-        this->patientsSick[idx]->setText(QString::number((*stocks)[ItemType::PatientSick]));
-    }
-    if(updates[1]){
-        this->patientsHealed[idx]->setText(QString::number((*stocks)[ItemType::PatientHealed]));
-    }
-    if(updates[2]){
-        this->syringes[idx]->setText(QString::number((*stocks)[ItemType::Syringe]));
-    }
-    if(updates[3]){
-        this->pills[idx]->setText(QString::number((*stocks)[ItemType::Pill]));
-    }
-    if(updates[4]){
-        this->scalpels[idx]->setText(QString::number((*stocks)[ItemType::Scalpel]));
-    }
-    if(updates[5]){
-        this->thermometers[idx]->setText(QString::number((*stocks)[ItemType::Thermometer]));
+    if (category.lines.size() <= LINK_BUNDLE_THRESHOLD) {
+        for (const QLineF& line : category.lines) {
+            path.moveTo(line.p1());
+            path.lineTo(line.p2());
+        }
+    } else {
+        // Faisceau : chaque extrémité distincte est reliée une seule fois à un point commun,
+        // le nombre de segments suit le nombre d'entités et non le nombre de liens
+        // Les extrémités déjà vues sont retrouvées par hachage de leurs coordonnées, en temps constant
+        std::vector<QPointF> ends1, ends2;
+        QSet<QPair<qreal, qreal>> seen1, seen2;
+        QPointF sum1, sum2;
+        for (const QLineF& line : category.lines) {
+            if (!seen1.contains({line.p1().x(), line.p1().y()})) {
+                seen1.insert({line.p1().x(), line.p1().y()});
+                ends1.push_back(line.p1());
+                sum1 += line.p1();
+            }
+            if (!seen2.contains({line.p2().x(), line.p2().y()})) {
+                seen2.insert({line.p2().x(), line.p2().y()});
+                ends2.push_back(line.p2());
+                sum2 += line.p2();
+            }
+        }
+        const QPointF center1 = sum1 / ends1.size();
+        const QPointF center2 = sum2 / ends2.size();
+        const QPointF hub = (center1 + center2) / 2;
+
+        for (const auto* ends : {&ends1, &ends2}) {
+            for (const QPointF& end : *ends) {
+                path.moveTo(end);
+                path.quadTo(QPointF(hub.x(), end.y()), hub);
+            }
+        }
     }
-    if(updates[6]){
-        this->stethoscopes[idx]->setText(QString::number((*stocks)[ItemType::Stethoscope]));
+
+    category.item->setPath(path);
+    category.dirty = false;
+}
+
+void DisplayView::update_stocks(int idx, std::map<ItemType, int>* stocks) {
+    // Seules les ressources affichées pour l'entité sont parcourues, sans copie ni insertion dans le stock
+    const ResourceMask mask = m_resourceMask[idx];
+    for (int i = 0; i < DISPLAYED_ITEM_TYPES; ++i) {
+        if (!(mask & (1u << i))) {
+            continue;
+        }
+        auto it = stocks->find(static_cast<ItemType>(i));
+        m_pendingStock[idx][i] = it != stocks->end() ? it->second : 0;
     }
+    markDirty(idx);
 }
@@ -7,9 +7,25 @@
 #include <QGraphicsSimpleTextItem>
 #include <QLine>
 #include <QPen>
+#include <QColor>
+#include <QPainter>
+#include <QPixmap>
+#include <QStyleOptionGraphicsItem>
+#include <QWheelEvent>
+#include <QTimer>
+#include <QGraphicsPathItem>
+#include <QPainterPath>
 
 #include "seller.h"
 
+#include <array>
+#include <cstdint>
+
+// Nombre de types de ressources affichables : les items du catalogue intégré (Nothing exclu).
+// Les items chargés dans ItemRegistry n'ont pas d'icône et ne sont pas affichés
+constexpr int DISPLAYED_ITEM_TYPES = static_cast<int>(NB_ITEM_TYPES);
+static_assert(DISPLAYED_ITEM_TYPES <= 32, "ResourceMask a un bit par ressource affichée");
+
 class ResourceItem : public QObject, public QGraphicsPixmapItem {
     Q_OBJECT
         Q_PROPERTY(QPointF pos READ pos WRITE setPos)
@@ -50,6 +66,53 @@ class ProductionItem : public QObject, public QGraphicsPixmapItem {
         PcoSemaphore sem;
 };
 
+/**
+ * @brief Dessine en un seul item toutes les entités d'une colonne (icône de l'entité, icône et texte des fonds,
+ *        icônes et textes des ressources). Seules les lignes visibles (exposedRect) sont peintes ; quand les
+ *        lignes se chevauchent à l'écran (vue dézoomée), elles sont agrégées en une bande unique.
+ */
+class EntityColumnItem : public QGraphicsItem {
+public:
+    EntityColumnItem(qreal x, qreal width, const QPixmap& fundIcon, QColor aggregateColor);
+
+    /**
+     * @brief addRow
+     * Ajoute une entité. Les lignes doivent être ajoutées par y croissant.
+     * @return L'indice de la ligne, à passer à setFundText et setStockText
+     */
+    std::size_t addRow(qreal y, const QPixmap& icon, std::vector<QPixmap> resources);
+
+    /**
+     * @brief setFundText / setStockText
+     * Changent un texte de la ligne et n'invalident que sa zone ; il sera dessiné au prochain passage de paint.
+     */
+    void setFundText(std::size_t row, const QString& text);
+    void setStockText(std::size_t row, std::size_t slot, const QString& text);
+
+    QRectF boundingRect() const override;
+    void paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget* widget) override;
+
+private:
+    struct Row {
+        qreal y;
+        QPixmap icon;
+        std::vector<QPixmap> resources;
+        QString fund;
+        std::vector<QString> stocks;   // Un texte par ressource, dans l'ordre de resources
+    };
+
+    QRectF fundRect(const Row& row) const;
+    QRectF stockRect(const Row& row, std::size_t slot) const;
+
+    qreal m_x;
+    qreal m_width;
+    QPixmap m_fundIcon;
+    QColor m_aggregateColor;
+    qreal m_rowExtent;          // Hauteur maximale d'une ligne (icônes comprises)
+    std::vector<Row> m_rows;
+    QRectF m_bounds;
+};
+
 class DisplayView : public QGraphicsView
 {
     Q_OBJECT
@@ -57,31 +120,59 @@ public:
     DisplayView(unsigned int nbSuppliers, unsigned int nbClinic, unsigned int nbHospitals, QWidget *parent);
     //~DisplayView();
 
-    std::vector<QGraphicsSimpleTextItem*> funds;
-    std::vector<QGraphicsSimpleTextItem*> syringes;
-    std::vector<QGraphicsSimpleTextItem*> pills;
-    std::vector<QGraphicsSimpleTextItem*> scalpels;
-    std::vector<QGraphicsSimpleTextItem*> thermometers;
-    std::vector<QGraphicsSimpleTextItem*> stethoscopes;
-    std::vector<QGraphicsSimpleTextItem*> patientsSick;
-    std::vector<QGraphicsSimpleTextItem*> patientsHealed;
-
-    std::vector<ProductionItem*> m_productItem;
-
-
+    /**
+     * @brief update_stocks / update_fund
+     * Mémorisent la nouvelle valeur ; le texte n'est réécrit qu'au prochain rafraîchissement
+     * et seulement si la valeur affichée a changé.
+     */
     void update_stocks(int idx, std::map<ItemType, int>* stocks);
-    void update_fund(int idx, QString fund);
+    void update_fund(int idx, unsigned fund);
 
     void set_link(int from, int to);
 
+protected:
+    void wheelEvent(QWheelEvent* event) override;
+
 private:
     QGraphicsScene *m_scene;
 
-    std::vector<std::vector<bool>> resourceAssociations;
-
-    void place_resources(int x, int y, int id, std::vector<bool> resources);
+    // Table des entités, une colonne par attribut, indexée par l'identifiant de l'entité
+    using ResourceMask = std::uint32_t;   // Bit i : la ressource ItemType(i) est affichée pour l'entité
+
+    std::vector<ResourceMask> m_resourceMask;
+    std::vector<EntityColumnItem*> m_entityColumn; // Colonne qui dessine l'entité
+    std::vector<std::size_t> m_entityRow;          // Ligne de l'entité dans sa colonne
+    std::vector<QPointF> m_entityPos;     // Position de l'icône de chaque entité
+    std::vector<qreal> m_entityHeight;    // Hauteur de l'icône de chaque entité
+
+    // Dernières valeurs reçues et valeurs affichées (NOT_SHOWN tant que rien n'est affiché)
+    static constexpr long long NOT_SHOWN = -1;
+    std::vector<std::array<int, DISPLAYED_ITEM_TYPES>> m_pendingStock;
+    std::vector<std::array<long long, DISPLAYED_ITEM_TYPES>> m_shownStock;
+    std::vector<unsigned> m_pendingFund;
+    std::vector<long long> m_shownFund;
+
+    std::vector<bool> m_dirty;              // Entité modifiée depuis le dernier rafraîchissement
+    std::vector<int> m_dirtyEntities;
+    QTimer m_frameTimer;                    // Regroupe les mises à jour d'une même image
+
+    void markDirty(int idx);
+
+    // Liens regroupés par catégorie (couleur) : un seul item de la scène par catégorie,
+    // dessiné en faisceau au-delà de LINK_BUNDLE_THRESHOLD liens
+    struct LinkCategory {
+        QGraphicsPathItem* item = nullptr;
+        std::vector<QLineF> lines;
+        bool dirty = false;
+    };
+    std::vector<LinkCategory> m_links;
+
+    void rebuildLinks(LinkCategory& category);
+    void place_resources(EntityColumnItem* column, int x, int y, int id, const QPixmap& icon);
     void createResourceAssociations(unsigned int nbSuppliers, unsigned int nbHospitals, unsigned int nbClinic);
-public slots:
+
+private slots:
+    void flushUpdates();
 
 };
 
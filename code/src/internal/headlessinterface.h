@@ -0,0 +1,55 @@
+#ifndef HEADLESSINTERFACE_H
+#define HEADLESSINTERFACE_H
+
+#include <atomic>
+#include <random>
+#include <pcosynchro/pcothread.h>
+
+#include "iwindowinterface.h"
+
+// Unité de temps (µs) des attentes simulées ; WindowInterface utilise 10000 µs
+#define HEADLESS_WORK_UNIT_US 100
+
+/**
+ * @brief Interface sans affichage, une instance par simulation.
+ *        Les mises à jour sont ignorées, seuls les messages de console sont comptés.
+ *        simulateWork reproduit le tirage de WindowInterface (1 à 100 unités) avec une unité réduite,
+ *        pour que plusieurs simulations tiennent dans un temps raisonnable.
+ */
+class HeadlessInterface : public IWindowInterface {
+public:
+    explicit HeadlessInterface(unsigned workUnitUs = HEADLESS_WORK_UNIT_US) : workUnitUs(workUnitUs) {}
+
+    void consoleAppendText(unsigned int consoleId, QString text) override {
+        nbMessages.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void updateFund(unsigned int id, unsigned new_fund) override {}
+
+    void updateStock(unsigned int id, std::map<ItemType, int>* stocks) override {}
+
+    void setLink(int from, int to) override {}
+
+    void setUtils(Utils* utils) override {}
+
+    void simulateWork() override {
+        if (workUnitUs) {
+            PcoThread::usleep(workDuration());
+        }
+    }
+
+    unsigned workDuration() override {
+        thread_local std::mt19937 rng(std::random_device{}());
+        return workUnitUs ? (rng() % 100 + 1) * workUnitUs : 0;
+    }
+
+    unsigned long getNbMessages() const {
+        return nbMessages.load(std::memory_order_relaxed);
+    }
+
+private:
+    unsigned workUnitUs;
+    std::atomic<unsigned long> nbMessages{0};
+};
+
+#endif // HEADLESSINTERFACE_H
@@ -18,6 +18,12 @@ public:
     virtual void setLink(int from, int to) = 0;
     virtual void setUtils(Utils* utils) = 0;
     virtual void simulateWork() = 0;
+
+    /**
+     * @brief Durée (µs) d'une attente simulée, tirée comme dans simulateWork. Les routines en coroutines
+     *        l'attendent avec co_await au lieu de bloquer leur thread (cf. ActorScheduler::sleep).
+     */
+    virtual unsigned workDuration() { return 0; }
 };
 
 #endif // IWINDOWINTERFACE_H
@@ -0,0 +1,123 @@
+#include <QString>
+#include <QTextStream>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <pcosynchro/pcomutex.h>
+#include <pcosynchro/pcothread.h>
+
+#include "arena.h"
+
+// Banc de faux partage : chaque thread achète chez son propre vendeur, il n'y a donc aucun partage logique.
+// Les deux dispositions sont compilées dans le même exécutable et mesurées l'une après l'autre :
+// vendeurs collés les uns aux autres, puis vendeurs alignés sur une ligne de cache comme dans la simulation.
+//
+// Exemple : pco_hospital_layout --sellers 8 --calls 200000 --rounds 3
+//
+// Le rapport final est le débit de la disposition alignée divisé par celui de la disposition collée.
+
+#define LAYOUT_DEFAULT_CALLS 200000
+#define LAYOUT_DEFAULT_ROUNDS 3
+
+/**
+ * @brief État d'un vendeur modifié à chaque achat, comme dans Supplier::request : unités prises sans verrou,
+ *        puis caisse et compteur mis à jour sous le mutex. Padding fixe l'alignement (et donc l'écart) entre
+ *        deux vendeurs voisins.
+ */
+template<std::size_t Padding>
+struct alignas(std::max(Padding, alignof(PcoMutex))) BenchSeller {
+    std::atomic<int> units{0};
+    PcoMutex mutex;
+    int money = 0;
+    int nbSupplied = 0;
+
+    void request(int qty) {
+        int available = units.load(std::memory_order_acquire);
+        while (available >= qty && !units.compare_exchange_weak(available, available - qty, std::memory_order_acquire)) {}
+
+        mutex.lock();
+        if (available >= qty) {
+            money += qty;
+            nbSupplied += qty;
+        }
+        mutex.unlock();
+    }
+};
+
+/**
+ * @brief measure
+ * Construit les vendeurs à la suite dans une arène, comme createSuppliers, puis fait acheter chaque thread
+ * chez son vendeur.
+ * @return Le débit en achats par seconde
+ */
+template<std::size_t Padding>
+static double measure(int nbSellers, int nbCalls) {
+    SimulationArena arena;
+    std::vector<BenchSeller<Padding>*> sellers;
+    for (int i = 0; i < nbSellers; ++i) {
+        sellers.push_back(arena.create<BenchSeller<Padding>>());
+        sellers.back()->units = nbCalls;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::unique_ptr<PcoThread>> threads;
+    for (BenchSeller<Padding>* seller : sellers) {
+        threads.emplace_back(std::make_unique<PcoThread>([seller, nbCalls]() {
+            for (int i = 0; i < nbCalls; ++i) {
+                seller->request(1);
+            }
+        }));
+    }
+    for (auto& thread : threads) {
+        thread->join();
+    }
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return nbSellers * double(nbCalls) / elapsed.count();
+}
+
+int main(int argc, char *argv[])
+{
+    int nbSellers = std::max(2, int(std::thread::hardware_concurrency()));
+    int nbCalls = LAYOUT_DEFAULT_CALLS;
+    int nbRounds = LAYOUT_DEFAULT_ROUNDS;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        QString option(argv[i]);
+        QString value(argv[i + 1]);
+        if (option == "--sellers") {
+            nbSellers = std::max(1, value.toInt());
+        } else if (option == "--calls") {
+            nbCalls = std::max(1, value.toInt());
+        } else if (option == "--rounds") {
+            nbRounds = std::max(1, value.toInt());
+        } else {
+            QTextStream(stderr) << "Unknown option " << option << "\n";
+            return -1;
+        }
+    }
+
+    using Packed = BenchSeller<1>;
+    using Padded = BenchSeller<CACHE_LINE_SIZE>;
+
+    // Meilleur débit sur plusieurs tours, les deux dispositions alternées pour subir les mêmes perturbations
+    double packed = 0.0;
+    double padded = 0.0;
+    for (int round = 0; round < nbRounds; ++round) {
+        packed = std::max(packed, measure<1>(nbSellers, nbCalls));
+        padded = std::max(padded, measure<CACHE_LINE_SIZE>(nbSellers, nbCalls));
+    }
+
+    QTextStream out(stdout);
+    out << QString("%1 %2 %3\n").arg("layout", 8).arg("bytes", 6).arg("requests/s", 14);
+    out << QString("%1 %2 %3\n").arg("packed", 8).arg(int(sizeof(Packed)), 6).arg(packed, 14, 'f', 0);
+    out << QString("%1 %2 %3\n").arg("padded", 8).arg(int(sizeof(Padded)), 6).arg(padded, 14, 'f', 0);
+    out << QString("padded / packed : %1 (%2 sellers, %3 calls each)\n")
+               .arg(packed > 0 ? padded / packed : 0.0, 0, 'f', 2).arg(nbSellers).arg(nbCalls);
+
+    return 0;
+}
@@ -1,10 +1,11 @@
 #include <QApplication>
 
 #include "utils.h"
+#include "replay.h"
+#include "itemregistry.h"
 #include "iwindowinterface.h"
-#ifdef TESTING_MODE
-#include "fakeinterface.h"
-#else
+#include "headlessinterface.h"
+#ifndef TESTING_MODE
 #include "windowinterface.h"
 #endif
 
@@ -14,19 +15,99 @@ int main(int argc, char *argv[])
 
     IWindowInterface* windowInterface;
 
+    // --track-patients : suit chaque patient et ajoute les histogrammes de latence par étape au rapport final
+    // --latency-csv <fichier> : suit les patients et exporte les histogrammes de latence en fin de simulation
+    // --record <fichier> : enregistre l'ordre des transactions et les graines aléatoires
+    // --replay <fichier> : rejoue un enregistrement sans interface graphique et affiche le rapport final
+    // --placement <none|spread|clustered> : épingle les threads des acteurs sur des groupes de cœurs
+    // --placement-groups <n> : nombre de groupes de cœurs du placement (défaut : topologie détectée)
+    // --producers <n> : nombre de producteurs par fournisseur (lots fabriqués en même temps)
+    // --mailboxes : les vendeurs échangent des ordres par boîtes aux lettres au lieu d'appels directs
+    // --doctors <n> : nombre de médecins par clinique (patients soignés en même temps)
+    // --doctor-threads : chaque médecin soigne sur son propre thread au lieu de la routine de la clinique
+    // --items <fichier> : ajoute des consommables au catalogue intégré (cf. ItemRegistry::load)
+    // --coroutines : les acteurs sont des coroutines sur un pool de threads (compilation C++20, PCO_COROUTINES)
+    // --coroutine-threads <n> : nombre de threads du pool des coroutines
+    QString latencyCsvPath;
+    QString recordPath;
+    QString replayPath;
+    SimulationConfig config;
+    for (int i = 1; i < argc; ++i) {
+        if (QString(argv[i]) == "--mailboxes") {
+            config.mailboxes = true;
+        } else if (QString(argv[i]) == "--coroutines") {
+            config.coroutines = true;
+        } else if (QString(argv[i]) == "--track-patients") {
+            config.trackPatients = true;
+        } else if (QString(argv[i]) == "--doctor-threads") {
+            config.doctorThreads = true;
+        }
+    }
+    for (int i = 1; i + 1 < argc; ++i) {
+        if (QString(argv[i]) == "--latency-csv") {
+            latencyCsvPath = argv[i + 1];
+            config.trackPatients = true;
+        } else if (QString(argv[i]) == "--record") {
+            recordPath = argv[i + 1];
+        } else if (QString(argv[i]) == "--replay") {
+            replayPath = argv[i + 1];
+        } else if (QString(argv[i]) == "--placement") {
+            QString mode = argv[i + 1];
+            if (mode == "spread") {
+                config.placement = PlacementMode::Spread;
+            } else if (mode == "clustered") {
+                config.placement = PlacementMode::Clustered;
+            } else if (mode != "none") {
+                qCritical() << "Unknown placement mode" << mode;
+                return -1;
+            }
+        } else if (QString(argv[i]) == "--placement-groups") {
+            config.placementGroups = QString(argv[i + 1]).toInt();
+        } else if (QString(argv[i]) == "--producers") {
+            config.producersPerSupplier = QString(argv[i + 1]).toInt();
+        } else if (QString(argv[i]) == "--doctors") {
+            config.doctorsPerClinic = QString(argv[i + 1]).toInt();
+        } else if (QString(argv[i]) == "--coroutine-threads") {
+            config.coroutineThreads = QString(argv[i + 1]).toInt();
+        } else if (QString(argv[i]) == "--items") {
+            // Avant la création des vendeurs : les fournisseurs lisent le registre à leur construction
+            if (!ItemRegistry::load(argv[i + 1])) {
+                qCritical() << "Could not load item registry" << argv[i + 1];
+                return -1;
+            }
+        }
+    }
+
+    if (!replayPath.isEmpty()) {
+        std::unique_ptr<Replay> replay = Replay::load(replayPath);
+        if (!replay) {
+            qCritical() << "Could not load replay log" << replayPath;
+            return -1;
+        }
+
+        // Tous les acteurs appellent l'interface en même temps : elle doit être sûre entre threads.
+        // Sans unité de temps, le rejeu ne fait aucune attente simulée
+        windowInterface = new HeadlessInterface(0);
+
+        Utils utils = Utils(config, windowInterface, latencyCsvPath, std::move(replay));
+        utils.waitEndOfService();
+        QTextStream(stdout) << utils.getFinalReport() << "\n";
+        return 0;
+    }
+
+    std::unique_ptr<Replay> recording;
+    if (!recordPath.isEmpty()) {
+        recording = Replay::record(recordPath);
+    }
+
     #ifdef TESTING_MODE
-        windowInterface = new FakeInterface();
+        windowInterface = new HeadlessInterface();
     #else
         WindowInterface::initialize(NB_SUPPLIER, NB_CLINICS, NB_HOSPITALS);
         windowInterface = new WindowInterface();
     #endif
 
-    Supplier::setInterface(windowInterface);
-    Clinic::setInterface(windowInterface);
-    Hospital::setInterface(windowInterface);
-    Ambulance::setInterface(windowInterface);
-
-    Utils utils = Utils(NB_SUPPLIER, NB_CLINICS, NB_HOSPITALS);
+    Utils utils = Utils(config, windowInterface, latencyCsvPath, std::move(recording));
     windowInterface->setUtils(&utils);
 
     return a.exec();
@@ -3,6 +3,9 @@
 
 #include "mainwindow.h"
 
+#include <QScrollBar>
+#include <QVBoxLayout>
+
 #include "utils.h"
 
 #define CONSOLE_MINIMUM_WIDTH 200
@@ -11,32 +14,48 @@ MainWindow::MainWindow(unsigned int nbMines, unsigned int nbFactories, unsigned
     QMainWindow(parent)
 {
     m_nbConsoles = nbMines + nbFactories + nbWholesalers;
-    m_consoles = std::vector<QTextEdit*>(m_nbConsoles);
 //    m_button = new QPushButton("Quit simulation", this);
 ////    m_button->setGeometry(QRect(QPoint(500, 500), QSize(200, 50)));
 //    m_button->show();
 
 //    connect(m_button, &QPushButton::released, this, &MainWindow::handleButton);
 
-    for (unsigned int i = 0; i < m_nbConsoles; ++i) {
-        m_consoles[i] = new QTextEdit(this);
-        m_consoles[i]->setMinimumWidth(CONSOLE_MINIMUM_WIDTH);
-    }
+    // Une seule console pour toutes les entités : le nombre de widgets ne dépend pas de la topologie
+    m_consoleModel = new ConsoleModel(m_nbConsoles, this);
 
-    m_docks = std::vector<QDockWidget*>(m_nbConsoles);
-
-    for (unsigned int i = 0; i < m_nbConsoles; ++i){
-        m_docks[i] = new QDockWidget(this);
-        m_docks[i]->setWidget(m_consoles[i]);
-    }
-
-    for(unsigned int i = 0; i < m_nbConsoles/2; i++) {
-        this->addDockWidget(Qt::LeftDockWidgetArea, m_docks[i]);
-    }
-
-    for(unsigned int i = m_nbConsoles/2; i < m_nbConsoles; i++) {
-        this->addDockWidget(Qt::RightDockWidgetArea, m_docks[i]);
+    m_consoleFilter = new QComboBox();
+    m_consoleFilter->addItem("All", ConsoleModel::ALL_ENTITIES);
+    for (unsigned int i = 0; i < m_nbConsoles; ++i) {
+        m_consoleFilter->addItem(QString("Entity %1").arg(i), static_cast<int>(i));
     }
+    connect(m_consoleFilter, QOverload<int>::of(&QComboBox::currentIndexChanged), this, [this](int index) {
+        m_consoleModel->setFilter(m_consoleFilter->itemData(index).toInt());
+        m_consoleView->scrollToBottom();
+    });
+
+    m_consoleView = new QListView();
+    m_consoleView->setModel(m_consoleModel);
+    m_consoleView->setUniformItemSizes(true);
+    m_consoleView->setMinimumWidth(CONSOLE_MINIMUM_WIDTH);
+    m_consoleView->setSelectionMode(QAbstractItemView::NoSelection);
+
+    // Suivre les nouvelles lignes tant que l'utilisateur est en bas de la liste
+    connect(m_consoleModel, &QAbstractItemModel::rowsInserted, this, [this]() {
+        QScrollBar* bar = m_consoleView->verticalScrollBar();
+        if (bar->value() == bar->maximum()) {
+            m_consoleView->scrollToBottom();
+        }
+    });
+
+    auto consoleWidget = new QWidget();
+    auto consoleLayout = new QVBoxLayout(consoleWidget);
+    consoleLayout->setContentsMargins(0, 0, 0, 0);
+    consoleLayout->addWidget(m_consoleFilter);
+    consoleLayout->addWidget(m_consoleView);
+
+    m_consoleDock = new QDockWidget("Consoles", this);
+    m_consoleDock->setWidget(consoleWidget);
+    this->addDockWidget(Qt::LeftDockWidgetArea, m_consoleDock);
     
     display = new DisplayView(nbMines, nbFactories, nbWholesalers, this);
     setCentralWidget(display);
@@ -58,7 +77,7 @@ void MainWindow::consoleAppendText(unsigned int consoleId, const QString &text){
         return;
     }
 
-    m_consoles[consoleId]->append(text);
+    m_consoleModel->append(consoleId, text);
 }
 
 void MainWindow::updateStock(unsigned int id, std::map<ItemType, int>* stocks){
@@ -66,7 +85,7 @@ void MainWindow::updateStock(unsigned int id, std::map<ItemType, int>* stocks){
 }
 
 void MainWindow::updateFund(unsigned int id, unsigned new_fund){
-    display->update_fund(id, QString::number(new_fund));
+    display->update_fund(id, new_fund);
 }
 
 void MainWindow::set_link(int from, int to){
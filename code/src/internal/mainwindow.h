@@ -2,9 +2,11 @@
 #define MAINWINDOW_H
 
 #include "display.h"
+#include "consolemodel.h"
 
 #include <QMainWindow>
-#include <QTextEdit>
+#include <QListView>
+#include <QComboBox>
 #include <QDockWidget>
 #include <QCloseEvent>
 #include <QPushButton>
@@ -19,9 +21,10 @@ public:
 //    ~MainWindow();
 
     DisplayView * display;
-    std::vector<QTextEdit* > m_consoles;
-    std::vector<QDockWidget*> m_docks;
-//    std::vector<QTextBlock* > m_docks;
+    ConsoleModel* m_consoleModel;   // Lignes de toutes les consoles, en tampons circulaires
+    QListView* m_consoleView;       // Ne dessine que les lignes visibles
+    QComboBox* m_consoleFilter;
+    QDockWidget* m_consoleDock;
     void setUtils(Utils* utils);
 
 protected:
@@ -0,0 +1,24 @@
+#include "pixmapcache.h"
+
+std::map<QString, QPixmap> PixmapCache::originals;
+std::map<std::pair<QString, int>, QPixmap> PixmapCache::scaled;
+
+QPixmap PixmapCache::get(const QString& name, int width) {
+    auto key = std::make_pair(name, width);
+    auto it = scaled.find(key);
+    if (it != scaled.end()) {
+        return it->second;
+    }
+
+    auto original = originals.find(name);
+    if (original == originals.end()) {
+        original = originals.emplace(name, QPixmap(":/images/" + name + ".png")).first;
+    }
+
+    return scaled.emplace(key, original->second.scaledToWidth(width, Qt::SmoothTransformation)).first->second;
+}
+
+void PixmapCache::clear() {
+    scaled.clear();
+    originals.clear();
+}
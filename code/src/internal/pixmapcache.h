@@ -0,0 +1,34 @@
+#ifndef PIXMAPCACHE_H
+#define PIXMAPCACHE_H
+
+#include <QPixmap>
+#include <QString>
+#include <map>
+
+/**
+ * @brief Cache des images de l'application, compilées dans les ressources Qt (images.qrc).
+ *        Chaque image est décodée une seule fois, puis redimensionnée une seule fois par largeur demandée.
+ *        Comme QPixmap, le cache ne doit être utilisé que depuis le thread de l'interface graphique.
+ */
+class PixmapCache {
+public:
+    /**
+     * @brief get
+     * @param name Nom de l'image sans extension, ex. "hospital" pour images/hospital.png
+     * @param width Largeur voulue en pixels, la hauteur suit les proportions de l'image
+     * @return L'image redimensionnée (partagée implicitement, la copie est gratuite)
+     */
+    static QPixmap get(const QString& name, int width);
+
+    /**
+     * @brief clear
+     * Libère toutes les images du cache.
+     */
+    static void clear();
+
+private:
+    static std::map<QString, QPixmap> originals;
+    static std::map<std::pair<QString, int>, QPixmap> scaled;
+};
+
+#endif // PIXMAPCACHE_H
@@ -0,0 +1,168 @@
+#include <QString>
+#include <QTextStream>
+
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+#include <pcosynchro/pcothread.h>
+
+#include "shard.h"
+#include "headlessinterface.h"
+
+// Simulation partitionnée en plusieurs processus (cf. Shard) :
+//
+//   pco_hospital_shards --shards 2 --duration 3000 [--hospitals 4 --clinics 6 --suppliers 6 --work-unit 100]
+//   pco_hospital_shards --scaling 4 --duration 3000 [...] : débit avec 1, 2 puis 4 partitions
+//
+// Le coordinateur crée la mémoire partagée, lance une partition par processus, demande l'arrêt
+// après la durée donnée, puis additionne les bilans des partitions.
+
+#define SHARDS_DEFAULT_DURATION_MS 2000
+
+/**
+ * @brief Lance nbShards partitions, une par processus, pendant durationMs, puis recopie leurs bilans.
+ * @return false si une partition n'a pas démarré ou ne s'est pas terminée normalement
+ */
+static bool runShards(const SimulationConfig& config, int nbShards, int durationMs, unsigned workUnitUs,
+                      std::vector<ShardResult>& results) {
+    ShmSegment segment("/pco_hospital_" + std::to_string(getpid()), Shard::sharedMemorySize(config, nbShards));
+    if (!segment.isValid()) {
+        return false;
+    }
+    ShardControl* control = new (segment.data()) ShardControl();
+
+    std::vector<pid_t> children;
+    for (int k = 0; k < nbShards; ++k) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            HeadlessInterface interface(workUnitUs);
+            bool started;
+            {
+                Shard shard(config, k, nbShards, segment.data(), &interface);
+                started = shard.run();
+            }
+            _exit(started ? 0 : 1);
+        }
+        if (pid < 0) {
+            QTextStream(stderr) << "Could not start shard " << QString::number(k) << "\n";
+            control->stop = true;
+            break;
+        }
+        children.push_back(pid);
+    }
+
+    if (!control->stop) {
+        PcoThread::usleep(durationMs * 1000);
+        control->stop = true;
+    }
+
+    bool ok = children.size() == size_t(nbShards);
+    for (pid_t child : children) {
+        int status = 0;
+        waitpid(child, &status, 0);
+        ok = ok && WIFEXITED(status) && WEXITSTATUS(status) == 0;
+    }
+    if (!ok) {
+        QTextStream(stderr) << "A shard did not terminate properly\n";
+        return false;
+    }
+
+    results.assign(control->results, control->results + nbShards);
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    SimulationConfig config;
+    config.trackPatients = false; // Les fiches patients ne traversent pas les processus
+    int nbShards = 2;
+    int maxScalingShards = 0;
+    int durationMs = SHARDS_DEFAULT_DURATION_MS;
+    unsigned workUnitUs = HEADLESS_WORK_UNIT_US;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        QString option(argv[i]);
+        QString value(argv[i + 1]);
+        if (option == "--shards") {
+            nbShards = value.toInt();
+        } else if (option == "--scaling") {
+            maxScalingShards = value.toInt();
+        } else if (option == "--duration") {
+            durationMs = value.toInt();
+        } else if (option == "--suppliers") {
+            config.nbSuppliers = value.toInt();
+        } else if (option == "--clinics") {
+            config.nbClinics = value.toInt();
+        } else if (option == "--hospitals") {
+            config.nbHospitals = value.toInt();
+        } else if (option == "--work-unit") {
+            workUnitUs = value.toUInt();
+        } else {
+            QTextStream(stderr) << "Unknown option " << option << "\n";
+            return -1;
+        }
+    }
+
+    int largest = maxScalingShards ? maxScalingShards : nbShards;
+    if (nbShards < 1 || largest < 1 || largest > SHARD_MAX) {
+        QTextStream(stderr) << "The number of shards must be between 1 and " << QString::number(SHARD_MAX) << "\n";
+        return -1;
+    }
+
+    int nbAmbulances = (config.nbSuppliers + 2) / 3;
+    int startPatient = config.initialPatientsSick * nbAmbulances;
+    int startFund = config.supplierFund * config.nbSuppliers + config.clinicFund * config.nbClinics +
+                    config.hospitalFund * config.nbHospitals;
+    QTextStream out(stdout);
+
+    if (maxScalingShards) {
+        // Même réseau et même durée pour 1, 2, 4... partitions : débit en patients sortis et en appels distants.
+        // Avec --work-unit 0, les acteurs ne font que des transactions et le débit suit les cœurs occupés
+        out << "shards  discharged/s  remote calls/s  speedup\n";
+        double reference = 0;
+        for (int shards = 1; shards <= maxScalingShards; shards *= 2) {
+            std::vector<ShardResult> results;
+            if (!runShards(config, shards, durationMs, workUnitUs, results)) {
+                return -1;
+            }
+            long discharged = 0, remoteCalls = 0;
+            for (const ShardResult& r : results) {
+                discharged += r.discharged;
+                remoteCalls += r.remoteCalls;
+            }
+            double throughput = discharged * 1000.0 / durationMs;
+            if (shards == 1) {
+                reference = throughput;
+            }
+            out << QString("%1  %2  %3  %4\n")
+                       .arg(shards, 6)
+                       .arg(throughput, 12, 'f', 1)
+                       .arg(remoteCalls * 1000.0 / durationMs, 14, 'f', 1)
+                       .arg(reference > 0 ? throughput / reference : 0.0, 7, 'f', 2);
+        }
+        return 0;
+    }
+
+    std::vector<ShardResult> results;
+    if (!runShards(config, nbShards, durationMs, workUnitUs, results)) {
+        return -1;
+    }
+
+    ShardResult total{};
+    for (int k = 0; k < nbShards; ++k) {
+        const ShardResult& r = results[k];
+        out << QString("Shard %1 : fund %2, patients %3, discharged %4, remote calls %5\n")
+                   .arg(k).arg(r.fund).arg(r.patients).arg(r.discharged).arg(r.remoteCalls);
+        total.fund += r.fund;
+        total.patients += r.patients;
+        total.discharged += r.discharged;
+        total.rejectedAdmissions += r.rejectedAdmissions;
+    }
+    out << QString("The expected fund is : %1 and you got at the end : %2\n").arg(startFund).arg(total.fund);
+    out << QString("The expected patient is : %1 and you got at the end : %2\n").arg(startPatient).arg(total.patients);
+    out << QString("Admissions rejected by hospitals : %1\n").arg(total.rejectedAdmissions);
+    out << QString("Discharged patients : %1\n").arg(total.discharged);
+
+    return total.patients == startPatient ? 0 : 1;
+}
@@ -0,0 +1,173 @@
+#include <QString>
+#include <QStringList>
+#include <QTextStream>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include <pcosynchro/pcothread.h>
+
+#include "utils.h"
+#include "headlessinterface.h"
+
+// Balayage de paramètres sans interface graphique : chaque combinaison de paramètres est simulée
+// pendant une durée fixe, plusieurs simulations tournant en parallèle, chacune avec sa propre interface.
+//
+// Exemple : pco_hospital_sweep --beds 20,35,50 --hospital-fund 500,1000 --duration 3000
+//
+// Les listes (séparées par des virgules) : --beds, --hospital-fund, --clinic-fund, --supplier-fund, --patients
+// Les valeurs simples : --suppliers, --clinics, --hospitals, --duration (ms), --jobs, --work-unit (µs)
+// Les coûts (costs.h) se changent à la compilation, par exemple avec -DDOCTOR_COST=10.
+
+#define SWEEP_DEFAULT_DURATION_MS 2000
+#define SWEEP_SAMPLE_PERIOD_US 10000 // Période d'échantillonnage de l'occupation des lits
+
+struct SweepResult {
+    SimulationConfig config;
+    SimulationStats stats;
+    double bedOccupancy;  // Moyenne des échantillons, entre 0 et 1
+    double seconds;       // Durée réelle de la simulation
+};
+
+static std::vector<int> parseList(const QString& arg) {
+    std::vector<int> values;
+    for (const QString& value : arg.split(',')) {
+        bool ok = false;
+        int v = value.trimmed().toInt(&ok);
+        if (ok) {
+            values.push_back(v);
+        }
+    }
+    return values;
+}
+
+static SweepResult runSimulation(const SimulationConfig& config, int durationMs, unsigned workUnitUs) {
+    HeadlessInterface interface(workUnitUs);
+
+    auto start = std::chrono::steady_clock::now();
+    auto deadline = start + std::chrono::milliseconds(durationMs);
+
+    Utils utils(config, &interface);
+
+    double occupancySum = 0.0;
+    int nbSamples = 0;
+    while (std::chrono::steady_clock::now() < deadline) {
+        PcoThread::usleep(SWEEP_SAMPLE_PERIOD_US);
+        occupancySum += utils.getBedOccupancy();
+        ++nbSamples;
+    }
+
+    utils.externalEndService();
+
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+    return {config, utils.getStats(), nbSamples ? occupancySum / nbSamples : 0.0, elapsed.count()};
+}
+
+int main(int argc, char *argv[])
+{
+    SimulationConfig base;
+
+    std::vector<int> beds = {base.bedsPerHospital};
+    std::vector<int> hospitalFunds = {base.hospitalFund};
+    std::vector<int> clinicFunds = {base.clinicFund};
+    std::vector<int> supplierFunds = {base.supplierFund};
+    std::vector<int> patients = {base.initialPatientsSick};
+    int durationMs = SWEEP_DEFAULT_DURATION_MS;
+    int jobs = 0;
+    unsigned workUnitUs = HEADLESS_WORK_UNIT_US;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        QString option(argv[i]);
+        QString value(argv[i + 1]);
+        if (option == "--beds") {
+            beds = parseList(value);
+        } else if (option == "--hospital-fund") {
+            hospitalFunds = parseList(value);
+        } else if (option == "--clinic-fund") {
+            clinicFunds = parseList(value);
+        } else if (option == "--supplier-fund") {
+            supplierFunds = parseList(value);
+        } else if (option == "--patients") {
+            patients = parseList(value);
+        } else if (option == "--suppliers") {
+            base.nbSuppliers = value.toInt();
+        } else if (option == "--clinics") {
+            base.nbClinics = value.toInt();
+        } else if (option == "--hospitals") {
+            base.nbHospitals = value.toInt();
+        } else if (option == "--duration") {
+            durationMs = value.toInt();
+        } else if (option == "--jobs") {
+            jobs = value.toInt();
+        } else if (option == "--work-unit") {
+            workUnitUs = value.toUInt();
+        } else {
+            QTextStream(stderr) << "Unknown option " << option << "\n";
+            return -1;
+        }
+    }
+
+    std::vector<SimulationConfig> configs;
+    for (int b : beds) {
+        for (int hf : hospitalFunds) {
+            for (int cf : clinicFunds) {
+                for (int sf : supplierFunds) {
+                    for (int p : patients) {
+                        SimulationConfig config = base;
+                        config.bedsPerHospital = b;
+                        config.hospitalFund = hf;
+                        config.clinicFund = cf;
+                        config.supplierFund = sf;
+                        config.initialPatientsSick = p;
+                        configs.push_back(config);
+                    }
+                }
+            }
+        }
+    }
+
+    if (jobs <= 0) {
+        // Une simulation occupe un thread par acteur : on évite de surcharger les cœurs pour ne pas fausser le débit
+        int threadsPerRun = base.nbSuppliers + base.nbClinics + base.nbHospitals;
+        jobs = std::max(1, int(std::thread::hardware_concurrency()) / std::max(1, threadsPerRun));
+    }
+    jobs = std::min<int>(jobs, configs.size());
+
+    std::vector<SweepResult> results(configs.size());
+    std::atomic<size_t> next{0};
+    std::vector<std::unique_ptr<PcoThread>> workers;
+    for (int j = 0; j < jobs; ++j) {
+        workers.emplace_back(std::make_unique<PcoThread>([&]() {
+            for (size_t idx = next++; idx < configs.size(); idx = next++) {
+                results[idx] = runSimulation(configs[idx], durationMs, workUnitUs);
+            }
+        }));
+    }
+    for (auto& worker : workers) {
+        worker->join();
+    }
+
+    QTextStream out(stdout);
+    out << QString("%1 %2 %3 %4 %5 | %6 %7 %8 %9 %10 %11\n")
+               .arg("beds", 6).arg("h_fund", 8).arg("c_fund", 8).arg("s_fund", 8).arg("patients", 8)
+               .arg("healed", 8).arg("healed/s", 9).arg("bed_use", 8).arg("fund", 8).arg("expected", 8).arg("rejected", 8);
+    for (const SweepResult& r : results) {
+        out << QString("%1 %2 %3 %4 %5 | %6 %7 %8 %9 %10 %11\n")
+                   .arg(r.config.bedsPerHospital, 6)
+                   .arg(r.config.hospitalFund, 8)
+                   .arg(r.config.clinicFund, 8)
+                   .arg(r.config.supplierFund, 8)
+                   .arg(r.config.initialPatientsSick, 8)
+                   .arg(r.stats.dischargedPatients, 8)
+                   .arg(r.seconds > 0 ? r.stats.dischargedPatients / r.seconds : 0.0, 9, 'f', 2)
+                   .arg(QString::number(100.0 * r.bedOccupancy, 'f', 1) + "%", 8)
+                   .arg(r.stats.finalFund, 8)
+                   .arg(r.stats.expectedFund, 8)
+                   .arg(r.stats.rejectedAdmissions, 8);
+    }
+
+    return 0;
+}
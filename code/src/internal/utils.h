@@ -12,6 +12,8 @@
 #include "clinic.h"
 #include "hospital.h"
 #include "ambulance.h"
+#include "placement.h"
+#include "arena.h"
 
 #define NB_SUPPLIER 3
 #define NB_CLINICS 3
@@ -31,17 +33,117 @@
 
 #define MAX_BEDS_PER_HOSTPITAL 35
 
-std::vector<Ambulance*> createAmbulances(int nbAmbulances, int idStart);
-std::vector<Supplier*> createSuppliers(int nbSuppliers, int idStart);
-std::vector<Clinic*> createClinics(int nbClinics, int idStart);
-std::vector<Hospital*> createHospitals(int nbHospitals, int idStart);
+// Nombre de producteurs par fournisseur : lots fabriqués en même temps
+#define PRODUCERS_PER_SUPPLIER 1
+
+// Échanges par boîtes aux lettres : chaque vendeur traite les ordres reçus dans son propre thread
+#define ACTOR_MAILBOXES false
+
+// Routines des acteurs en coroutines sur un pool de threads, au lieu d'un thread par acteur.
+// Demande une compilation en C++20 (option CMake PCO_COROUTINES), sinon sans effet
+#define ACTOR_COROUTINES false
+// Nombre de threads du pool qui reprend les coroutines des acteurs
+#define COROUTINE_THREADS 4
+
+// Nombre de médecins par clinique : patients soignés en même temps par un traitement
+#define DOCTORS_PER_CLINIC 1
+// Médecins sur leurs propres threads, avec les kits préparés par la clinique ; sinon la routine de la clinique
+// soigne elle-même par lots de DOCTORS_PER_CLINIC patients. Sans effet pendant un enregistrement ou un rejeu
+#define DOCTOR_THREADS false
+
+// Suivi individuel des patients (fiches horodatées, histogrammes de latence par étape)
+#define TRACK_PATIENTS false
+
+// Placement des threads des acteurs sur les groupes de cœurs (cf. PlacementMode)
+#define ACTOR_PLACEMENT PlacementMode::None
+// Nombre de groupes de cœurs utilisés par le placement (0 : ceux détectés, nœuds NUMA ou caches L3)
+#define PLACEMENT_GROUPS 0
+
+/**
+ * @brief Paramètres d'une simulation. Les valeurs par défaut sont celles des macros ci-dessus.
+ */
+struct SimulationConfig {
+    int nbSuppliers = NB_SUPPLIER;
+    int nbClinics = NB_CLINICS;
+    int nbHospitals = NB_HOSPITALS;
+
+    int supplierFund = SUPPLIER_FUND;
+    int clinicFund = CLINICS_FUND;
+    int hospitalFund = HOSPITALS_FUND;
+    int bedsPerHospital = MAX_BEDS_PER_HOSTPITAL;
+    int doctorsPerClinic = DOCTORS_PER_CLINIC;
+    bool doctorThreads = DOCTOR_THREADS;
+    int producersPerSupplier = PRODUCERS_PER_SUPPLIER;
+    bool mailboxes = ACTOR_MAILBOXES;    // Sans effet pendant un enregistrement ou un rejeu (ordre total des transactions)
+    bool coroutines = ACTOR_COROUTINES;  // Sans effet pendant un enregistrement ou un rejeu, ni avec le placement
+    int coroutineThreads = COROUTINE_THREADS;
+    int initialPatientsSick = INITIAL_PATIENT_SICK;
+
+    bool trackPatients = TRACK_PATIENTS;
+
+    PlacementMode placement = ACTOR_PLACEMENT;
+    int placementGroups = PLACEMENT_GROUPS;
+};
+
+/**
+ * @brief Bilan chiffré d'une simulation terminée (cf. Utils::getStats).
+ */
+struct SimulationStats {
+    int expectedFund = 0;
+    int finalFund = 0;
+    int expectedPatients = 0;
+    int finalPatients = 0;
+    int dischargedPatients = 0;   // Patients sortis soignés des hôpitaux
+    int rejectedAdmissions = 0;
+    int crossGroupLinks = 0;      // Liens commerciaux entre groupes de cœurs différents (placement actif)
+    int crossGroupCalls = 0;      // Appels send/request reçus d'un autre groupe de cœurs (placement actif)
+};
+
+/**
+ * @brief createActor
+ * Construit dans l'arène l'acteur d'identifiant id, dont le rôle découle de la numérotation globale.
+ */
+Seller* createActor(const SimulationConfig& config, int id, IWindowInterface* windowInterface, SimulationArena& arena);
+std::vector<Ambulance*> createAmbulances(const SimulationConfig& config, int idStart, IWindowInterface* windowInterface, SimulationArena& arena);
+std::vector<Supplier*> createSuppliers(const SimulationConfig& config, int idStart, IWindowInterface* windowInterface, SimulationArena& arena);
+std::vector<Clinic*> createClinics(const SimulationConfig& config, int idStart, IWindowInterface* windowInterface, SimulationArena& arena);
+std::vector<Hospital*> createHospitals(const SimulationConfig& config, int idStart, IWindowInterface* windowInterface, SimulationArena& arena);
 
 class Utils {
 public:
     void externalEndService();
+
+    /**
+     * @brief waitEndOfService
+     * Attend que tous les acteurs se soient arrêtés d'eux-mêmes (fin d'un rejeu) et que le rapport final soit prêt.
+     */
+    void waitEndOfService();
     QString getFinalReport();
 
+    /**
+     * @brief getStats
+     * @return Le bilan de la simulation, valide une fois le service terminé.
+     */
+    SimulationStats getStats() const;
+
+    /**
+     * @brief getBedOccupancy
+     * @return La proportion de lits occupés dans tous les hôpitaux, lue sans verrou depuis leurs indications.
+     */
+    double getBedOccupancy() const;
+
 private:
+    // Toutes les entités et leurs listes de liens, libérées avec la simulation.
+    // Déclarées en premier : détruites après les threads qui les utilisent
+    SimulationArena arena;
+    // Avec placement : une arène par groupe de cœurs, remplie depuis un thread épinglé sur ce groupe
+    std::vector<std::unique_ptr<SimulationArena>> groupArenas;
+    LinkTable links;
+    // Suivi des patients (config.trackPatients), nul sinon. Ses fiches sont libérées avec la simulation
+    std::unique_ptr<PatientTracker> tracker;
+    // Enregistrement ou rejeu de cette simulation, nul sinon : seul ce Utils l'interrompt et le termine
+    std::unique_ptr<Replay> replay;
+
     std::vector<Ambulance*> ambulances;
     std::vector<Supplier*> suppliers;
     std::vector<Clinic*> clinics;
@@ -50,15 +152,89 @@ private:
     std::vector<std::unique_ptr<PcoThread>> threads;
     std::unique_ptr<PcoThread> utilsThread;
 
+#ifdef HAS_COROUTINE_ACTORS
+    // Pool qui fait tourner les routines des acteurs en coroutines (config.coroutines), nul sinon
+    std::unique_ptr<ActorScheduler> scheduler;
+#endif
+
+    SimulationConfig config;
+
+    // Placement des acteurs : graphe des liens, topologie et groupe de chaque acteur (indexé par uniqueId)
+    CpuTopology topology;
+    ActorPlacement placement;
+    std::vector<int> layout;
+
     QString finalReport;
+    SimulationStats stats;
+    QString latencyCsvPath;
 
     void endService();
 
+    /**
+     * @brief run
+     * Attend la fin de tous les acteurs (threads ou pool de coroutines), puis établit le bilan.
+     */
     void run();
 
+    /**
+     * @brief startActors
+     * Lance tous les acteurs, chacun sur son thread ou tous sur le pool de coroutines. Appelée par le constructeur :
+     * threads et pool existent avant que endService puisse les arrêter, et ne changent plus ensuite.
+     */
+    void startActors();
+
+    /**
+     * @brief startActor
+     * Lance le thread d'un acteur, épinglé sur son groupe de cœurs si le placement est actif.
+     */
+    template<typename Actor>
+    void startActor(Actor* actor);
+
+    /**
+     * @brief declareLinks
+     * Déclare au placement les liens entre acteurs, par identifiant, avant leur construction.
+     */
+    void declareLinks();
+
+    /**
+     * @brief placeActors
+     * Calcule la disposition des acteurs selon config.placement, une fois tous les liens déclarés.
+     */
+    void placeActors();
+
+    /**
+     * @brief createPlacedActors
+     * Construit les acteurs de chaque groupe depuis un thread épinglé sur ce groupe : leur mémoire est touchée en
+     * premier depuis le nœud local.
+     */
+    void createPlacedActors(IWindowInterface* windowInterface);
+
     PcoSemaphore semEnd{0};
+    bool serviceEnded = false;
 public:
-    Utils(int nbSupplier, int nbClinic, int nbHospital);
+    /**
+     * @brief Utils
+     * @param windowInterface Interface propre aux acteurs de cette simulation
+     * @param latencyCsvPath Fichier où exporter les histogrammes de latence en fin de simulation (vide : pas d'export)
+     */
+    Utils(int nbSupplier, int nbClinic, int nbHospital, IWindowInterface* windowInterface, QString latencyCsvPath = QString());
+
+    /**
+     * @brief Utils
+     * @param config Paramètres de la simulation
+     * @param windowInterface Interface propre aux acteurs de cette simulation : plusieurs simulations
+     *        indépendantes peuvent tourner dans le même processus, chacune avec la sienne
+     * @param replayLog Enregistrement ou rejeu de cette simulation (cf. Replay::record et Replay::load), nul sinon
+     */
+    Utils(const SimulationConfig& config, IWindowInterface* windowInterface, QString latencyCsvPath = QString(),
+          std::unique_ptr<Replay> replayLog = nullptr);
+
+    /**
+     * @brief ~Utils
+     * Arrête la simulation si ce n'est pas déjà fait, dégèle le registre des items, puis libère toutes les entités
+     * et leurs liens.
+     */
+    ~Utils();
 
 
 };
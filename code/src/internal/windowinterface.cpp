@@ -78,7 +78,14 @@ void WindowInterface::initialize(unsigned int nbExtractors, unsigned int nbFacto
 }
 
 void WindowInterface::simulateWork(){
-    PcoThread::usleep((rand() % 100 + 1) * 10000);
+    unsigned duration = workDuration();
+    if (duration) {
+        PcoThread::usleep(duration);
+    }
+}
+
+unsigned WindowInterface::workDuration(){
+    return (rand() % 100 + 1) * 10000;
 }
 
 void WindowInterface::setUtils(Utils* utils)
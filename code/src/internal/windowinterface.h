@@ -26,6 +26,7 @@ public:
     void setLink(int from, int to) override;
     void setUtils(Utils* utils) override;
     void simulateWork() override;
+    unsigned workDuration() override;
 
 private:
     static bool sm_didInitialize;
@@ -0,0 +1,91 @@
+#ifndef ITEMCATALOG_H
+#define ITEMCATALOG_H
+
+#include <QString>
+#include <array>
+#include <cstddef>
+
+#include "costs.h"
+
+enum class ItemType {
+    PatientSick, PatientHealed, Syringe, Pill, Scalpel, Thermometer, Stethoscope, Nothing
+};
+
+enum class EmployeeType {Supplier, Nurse, Doctor};
+
+// Nombre de types d'items réels (Nothing exclu), et indice d'un type dans un stock à plat
+constexpr std::size_t NB_ITEM_TYPES = static_cast<std::size_t>(ItemType::Nothing);
+constexpr std::size_t itemIndex(ItemType item) { return static_cast<std::size_t>(item); }
+
+/**
+ * @brief Fiche d'un type d'item dans le catalogue.
+ */
+struct ItemInfo {
+    ItemType type;
+    const char* name;      // Nom affiché dans les journaux
+    const char* image;     // Image de la ressource (":/images/<image>.png")
+    int cost;              // Prix d'une unité
+    EmployeeType producer; // Employé payé pour produire une unité
+};
+
+/**
+ * @brief Catalogue des items intégrés, indexé par ItemType (Nothing compris, en dernier).
+ *        Ajouter un type d'item intégré : une valeur dans ItemType et une ligne ici, à la même position.
+ *        Les consommables chargés depuis la configuration (ItemRegistry) prennent les identifiants suivants.
+ */
+constexpr std::array<ItemInfo, NB_ITEM_TYPES + 1> ITEM_CATALOG = {{
+    {ItemType::PatientSick,   "Patient Sick",   "patientSick",   TRANSFER_COST,    EmployeeType::Supplier},
+    {ItemType::PatientHealed, "Patient Healed", "patientHealed", HEALING_COST,     EmployeeType::Doctor},
+    {ItemType::Syringe,       "Syringe",        "syringe",       SYRINGUE_COST,    EmployeeType::Supplier},
+    {ItemType::Pill,          "Pill",           "pill",          PILL_COST,        EmployeeType::Supplier},
+    {ItemType::Scalpel,       "Scalpel",        "scalpel",       SCALPEL_COST,     EmployeeType::Supplier},
+    {ItemType::Thermometer,   "Thermometer",    "thermometer",   THERMOMETER_COST, EmployeeType::Supplier},
+    {ItemType::Stethoscope,   "Stethoscope",    "stethoscope",   STETHOSCOPE_COST, EmployeeType::Supplier},
+    {ItemType::Nothing,       "Nothing",        "",              0,                EmployeeType::Nurse},
+}};
+
+// Salaire de chaque employé, indexé par EmployeeType
+constexpr std::array<int, 3> EMPLOYEE_SALARIES = {SUPPLIER_COST, NURSE_COST, DOCTOR_COST};
+
+// Le catalogue doit suivre l'ordre de ItemType : une ligne oubliée ou déplacée ne compile pas
+constexpr bool catalogFollowsItemType() {
+    for (std::size_t i = 0; i < ITEM_CATALOG.size(); ++i) {
+        if (itemIndex(ITEM_CATALOG[i].type) != i) {
+            return false;
+        }
+    }
+    return true;
+}
+static_assert(catalogFollowsItemType(), "ITEM_CATALOG doit avoir une ligne par ItemType, dans l'ordre de l'énumération");
+
+constexpr const ItemInfo& getItemInfo(ItemType item) {
+    return ITEM_CATALOG[itemIndex(item)];
+}
+
+// Items chargés au-delà du catalogue (cf. ItemRegistry), lus à l'exécution
+int registeredCost(ItemType item);
+EmployeeType registeredProducer(ItemType item);
+
+constexpr bool isCatalogItem(ItemType item) {
+    return itemIndex(item) < ITEM_CATALOG.size();
+}
+
+constexpr int getCostPerUnit(ItemType item) {
+    return isCatalogItem(item) ? getItemInfo(item).cost : registeredCost(item);
+}
+
+constexpr EmployeeType getEmployeeThatProduces(ItemType item) {
+    return isCatalogItem(item) ? getItemInfo(item).producer : registeredProducer(item);
+}
+
+constexpr int getEmployeeSalary(EmployeeType employee) {
+    return EMPLOYEE_SALARIES[static_cast<std::size_t>(employee)];
+}
+
+/**
+ * @brief getItemName
+ * @return Le nom de l'item, construit une seule fois pour tout le programme
+ */
+const QString& getItemName(ItemType item);
+
+#endif // ITEMCATALOG_H
@@ -0,0 +1,251 @@
+#include "itemregistry.h"
+#include <QStringList>
+#include <algorithm>
+#include <fstream>
+#include <mutex>
+#include <string>
+
+namespace {
+
+std::vector<RegisteredItem> builtinItems() {
+    std::vector<RegisteredItem> items;
+    for (const ItemInfo& info : ITEM_CATALOG) {
+        items.push_back({QString(info.name), QString(info.image), info.cost, info.producer, SupplierKind::None});
+    }
+    return items;
+}
+
+// Rempli avant la simulation, seulement lu ensuite
+std::vector<RegisteredItem>& registry() {
+    static std::vector<RegisteredItem> items = builtinItems();
+    return items;
+}
+
+// Les écritures et le gel sont exclusifs : une écriture ne peut pas commencer pendant la vie d'une simulation
+std::mutex writeMutex;
+int nbFreezes = 0;
+
+ItemType findIn(const std::vector<RegisteredItem>& items, const QString& name) {
+    for (std::size_t i = 0; i < items.size(); ++i) {
+        if (items[i].name == name && i != itemIndex(ItemType::Nothing)) {
+            return static_cast<ItemType>(i);
+        }
+    }
+    return ItemType::Nothing;
+}
+
+ItemType addLocked(const RegisteredItem& item) {
+    if (registry().size() >= MAX_ITEM_TYPES || findIn(registry(), item.name) != ItemType::Nothing) {
+        return ItemType::Nothing;
+    }
+    registry().push_back(item);
+    return static_cast<ItemType>(registry().size() - 1);
+}
+
+bool parseSupplier(const QString& text, SupplierKind& kind) {
+    if (text == "devices") {
+        kind = SupplierKind::MedicalDevice;
+    } else if (text == "pharmacy") {
+        kind = SupplierKind::Pharmacy;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+}
+
+int registeredCost(ItemType item) {
+    return ItemRegistry::get(item).cost;
+}
+
+EmployeeType registeredProducer(ItemType item) {
+    return ItemRegistry::get(item).producer;
+}
+
+std::size_t ItemSet::count() const {
+    std::size_t total = 0;
+    for (std::uint64_t word : words) {
+        total += __builtin_popcountll(word);
+    }
+    return total;
+}
+
+ItemSet& ItemSet::operator|=(const ItemSet& other) {
+    for (std::size_t i = 0; i < words.size(); ++i) {
+        words[i] |= other.words[i];
+    }
+    return *this;
+}
+
+std::vector<ItemType> ItemSet::items() const {
+    std::vector<ItemType> result;
+    for (std::size_t i = 0; i < words.size(); ++i) {
+        for (std::uint64_t word = words[i]; word; word &= word - 1) {
+            result.push_back(static_cast<ItemType>(i * 64 + __builtin_ctzll(word)));
+        }
+    }
+    return result;
+}
+
+std::vector<SparseStock::Entry>::const_iterator SparseStock::lowerBound(ItemType item) const {
+    return std::lower_bound(entries.begin(), entries.end(), item,
+                            [](const Entry& entry, ItemType type) { return entry.first < type; });
+}
+
+int SparseStock::get(ItemType item) const {
+    auto it = lowerBound(item);
+    return it != entries.end() && it->first == item ? it->second : 0;
+}
+
+bool SparseStock::contains(ItemType item) const {
+    auto it = lowerBound(item);
+    return it != entries.end() && it->first == item;
+}
+
+int& SparseStock::operator[](ItemType item) {
+    auto it = entries.begin() + (lowerBound(item) - entries.cbegin());
+    if (it == entries.end() || it->first != item) {
+        it = entries.insert(it, {item, 0});
+    }
+    return it->second;
+}
+
+void SparseStock::copyTo(std::map<ItemType, int>& map) const {
+    if (map.size() != entries.size()) {
+        map.clear();
+        for (const Entry& entry : entries) {
+            map.emplace_hint(map.end(), entry.first, entry.second);
+        }
+        return;
+    }
+
+    // Mêmes types dans le même ordre : on ne recopie que les quantités
+    auto entry = entries.begin();
+    for (auto& item : map) {
+        item.second = entry->second;
+        ++entry;
+    }
+}
+
+bool ItemRegistry::load(const QString& path) {
+    std::ifstream in(path.toStdString());
+    if (!in) {
+        return false;
+    }
+
+    std::vector<RegisteredItem> loaded;
+    std::string rawLine;
+    while (std::getline(in, rawLine)) {
+        // trimmed retire aussi le '\r' des fichiers CRLF
+        QString line = QString::fromStdString(rawLine).trimmed();
+        if (line.isEmpty() || line.startsWith('#')) {
+            continue;
+        }
+
+        QStringList fields = line.split(';');
+        for (QString& field : fields) {
+            field = field.trimmed();
+        }
+
+        RegisteredItem item;
+        bool costOk = false;
+        if (fields.size() < 3 || fields[0].isEmpty() || !parseSupplier(fields[2], item.supplier)) {
+            return false;
+        }
+        // Nombre complet exigé : "12abc" est refusé
+        item.cost = fields[1].toInt(&costOk);
+        if (!costOk) {
+            return false;
+        }
+        item.name = fields[0];
+        item.image = fields.size() > 3 ? fields[3] : QString();
+        item.producer = EmployeeType::Supplier;
+        loaded.push_back(item);
+    }
+
+    std::lock_guard<std::mutex> lock(writeMutex);
+    if (nbFreezes > 0) {
+        return false;
+    }
+
+    // Tout ou rien : on vérifie la place et les noms avant d'ajouter le premier item
+    if (registry().size() + loaded.size() > MAX_ITEM_TYPES) {
+        return false;
+    }
+    for (std::size_t i = 0; i < loaded.size(); ++i) {
+        if (findIn(registry(), loaded[i].name) != ItemType::Nothing) {
+            return false;
+        }
+        for (std::size_t j = 0; j < i; ++j) {
+            if (loaded[j].name == loaded[i].name) {
+                return false;
+            }
+        }
+    }
+    for (const RegisteredItem& item : loaded) {
+        addLocked(item);
+    }
+    return true;
+}
+
+ItemType ItemRegistry::add(const RegisteredItem& item) {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    return nbFreezes > 0 ? ItemType::Nothing : addLocked(item);
+}
+
+void ItemRegistry::reset() {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    if (nbFreezes == 0) {
+        registry() = builtinItems();
+    }
+}
+
+void ItemRegistry::freeze() {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    ++nbFreezes;
+}
+
+void ItemRegistry::thaw() {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    assert(nbFreezes > 0);
+    --nbFreezes;
+}
+
+bool ItemRegistry::isFrozen() {
+    std::lock_guard<std::mutex> lock(writeMutex);
+    return nbFreezes > 0;
+}
+
+std::size_t ItemRegistry::size() {
+    return registry().size();
+}
+
+const RegisteredItem& ItemRegistry::get(ItemType item) {
+    return registry()[itemIndex(item)];
+}
+
+ItemType ItemRegistry::find(const QString& name) {
+    return findIn(registry(), name);
+}
+
+ItemSet ItemRegistry::suppliedBy(SupplierKind kind) {
+    ItemSet items;
+    const auto& all = registry();
+    for (std::size_t i = 0; i < all.size(); ++i) {
+        if (all[i].supplier == kind && kind != SupplierKind::None) {
+            items.insert(static_cast<ItemType>(i));
+        }
+    }
+    return items;
+}
+
+ItemSet ItemRegistry::all() {
+    ItemSet items;
+    for (std::size_t i = 0; i < registry().size(); ++i) {
+        if (i != itemIndex(ItemType::Nothing)) {
+            items.insert(static_cast<ItemType>(i));
+        }
+    }
+    return items;
+}
@@ -0,0 +1,180 @@
+#ifndef ITEMREGISTRY_H
+#define ITEMREGISTRY_H
+
+#include <QString>
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <initializer_list>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include "itemcatalog.h"
+
+// Nombre maximum de types d'items (catalogue intégré compris), taille des ensembles ItemSet
+#ifndef MAX_ITEM_TYPES
+#define MAX_ITEM_TYPES 1024
+#endif
+
+/**
+ * @brief Fournisseur qui produit un item enregistré.
+ */
+enum class SupplierKind { None, MedicalDevice, Pharmacy };
+
+/**
+ * @brief Type d'item connu du registre : ceux du catalogue intégré, puis ceux chargés depuis la configuration.
+ */
+struct RegisteredItem {
+    QString name;
+    QString image;          // Vide : pas d'icône dans l'affichage
+    int cost;
+    EmployeeType producer;
+    SupplierKind supplier;  // None pour les items du catalogue, produits selon les listes des fournisseurs
+};
+
+/**
+ * @brief Ensemble de types d'items, un bit par identifiant : test d'appartenance en temps constant, sans allocation.
+ */
+class ItemSet {
+public:
+    ItemSet() = default;
+    ItemSet(std::initializer_list<ItemType> items) {
+        for (ItemType item : items) {
+            insert(item);
+        }
+    }
+
+    void insert(ItemType item) {
+        assert(itemIndex(item) < MAX_ITEM_TYPES);
+        if (itemIndex(item) < MAX_ITEM_TYPES) {
+            words[itemIndex(item) / 64] |= std::uint64_t(1) << (itemIndex(item) % 64);
+        }
+    }
+    void erase(ItemType item) {
+        if (itemIndex(item) < MAX_ITEM_TYPES) {
+            words[itemIndex(item) / 64] &= ~(std::uint64_t(1) << (itemIndex(item) % 64));
+        }
+    }
+
+    bool contains(ItemType item) const {
+        return itemIndex(item) < MAX_ITEM_TYPES && (words[itemIndex(item) / 64] >> (itemIndex(item) % 64)) & 1;
+    }
+
+    std::size_t count() const;
+    bool empty() const { return count() == 0; }
+
+    ItemSet& operator|=(const ItemSet& other);
+
+    /**
+     * @brief items
+     * @return Les types de l'ensemble, par identifiant croissant
+     */
+    std::vector<ItemType> items() const;
+
+private:
+    std::array<std::uint64_t, (MAX_ITEM_TYPES + 63) / 64> words{};
+};
+
+/**
+ * @brief Inventaire creux : seuls les types présents sont stockés, triés par identifiant dans un tableau contigu
+ *        (recherche dichotomique, parcours linéaire sans pointeurs). Adapté à quelques dizaines d'items
+ *        parmi des centaines de types enregistrés.
+ */
+class SparseStock {
+public:
+    using Entry = std::pair<ItemType, int>;
+
+    /**
+     * @brief get
+     * @return La quantité en stock, 0 si le type est absent
+     */
+    int get(ItemType item) const;
+
+    /**
+     * @brief operator[]
+     * @return La quantité du type, ajouté avec une quantité nulle s'il est absent
+     */
+    int& operator[](ItemType item);
+
+    bool contains(ItemType item) const;
+
+    std::size_t size() const { return entries.size(); }
+    std::vector<Entry>::const_iterator begin() const { return entries.begin(); }
+    std::vector<Entry>::const_iterator end() const { return entries.end(); }
+
+    /**
+     * @brief copyTo
+     * Recopie les quantités dans une map : seules les valeurs sont mises à jour si la map a déjà les mêmes types.
+     */
+    void copyTo(std::map<ItemType, int>& map) const;
+
+private:
+    std::vector<Entry>::const_iterator lowerBound(ItemType item) const;
+
+    std::vector<Entry> entries;
+};
+
+/**
+ * @brief Registre des types d'items, à identifiants denses : 0 .. size() - 1.
+ *        Les premiers sont ceux du catalogue intégré (ITEM_CATALOG, Nothing compris), les suivants sont chargés
+ *        depuis un fichier de configuration. Le registre se remplit avant la création des vendeurs, puis il est
+ *        gelé (freeze) tant qu'une simulation existe : il n'est alors plus que lu, sans verrou.
+ */
+class ItemRegistry {
+public:
+    /**
+     * @brief load
+     * Ajoute les items d'un fichier texte, une ligne par item : "nom;coût;fournisseur[;image]",
+     * fournisseur valant "devices" ou "pharmacy". Les champs sont débarrassés de leurs blancs (fins de ligne CRLF
+     * comprises) ; le coût doit être un entier complet. Les lignes vides et celles commençant par # sont ignorées.
+     * @return false si le fichier est illisible, si une ligne est invalide ou si le registre est gelé
+     *         (aucun item n'est alors ajouté)
+     */
+    static bool load(const QString& path);
+
+    /**
+     * @brief add
+     * @return L'identifiant du nouvel item, ItemType::Nothing si le nom existe déjà, si le registre est plein
+     *         ou s'il est gelé
+     */
+    static ItemType add(const RegisteredItem& item);
+
+    /**
+     * @brief reset
+     * Retire les items chargés, seul le catalogue intégré reste. Sans effet si le registre est gelé.
+     */
+    static void reset();
+
+    /**
+     * @brief freeze / thaw
+     * Gèlent le registre pendant la vie d'une simulation (appels imbriqués comptés) : load, add et reset
+     * le refusent jusqu'au dernier thaw. Appelés par Utils et Shard avant de créer leurs acteurs.
+     */
+    static void freeze();
+    static void thaw();
+    static bool isFrozen();
+
+    static std::size_t size();
+    static const RegisteredItem& get(ItemType item);
+
+    /**
+     * @brief find
+     * @return L'identifiant de l'item portant ce nom, ItemType::Nothing s'il est inconnu
+     */
+    static ItemType find(const QString& name);
+
+    /**
+     * @brief suppliedBy
+     * @return Les items enregistrés produits par ce type de fournisseur
+     */
+    static ItemSet suppliedBy(SupplierKind kind);
+
+    /**
+     * @brief all
+     * @return Tous les types d'items réels (Nothing exclu)
+     */
+    static ItemSet all();
+};
+
+#endif // ITEMREGISTRY_H
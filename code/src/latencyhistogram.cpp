@@ -0,0 +1,107 @@
+#include "latencyhistogram.h"
+#include <algorithm>
+
+int LatencyHistogram::indexOf(std::int64_t value) {
+    if (value < SUB_BUCKETS) {
+        return static_cast<int>(value);
+    }
+    int exponent = 63 - __builtin_clzll(static_cast<unsigned long long>(value));
+    if (exponent > MAX_EXPONENT) {
+        return NB_BUCKETS - 1;
+    }
+    int shift = exponent - SUB_BUCKET_BITS;
+    return SUB_BUCKETS + shift * SUB_BUCKETS + static_cast<int>((value >> shift) - SUB_BUCKETS);
+}
+
+std::int64_t LatencyHistogram::lowestValueAt(int index) {
+    if (index < SUB_BUCKETS) {
+        return index;
+    }
+    int shift = (index - SUB_BUCKETS) / SUB_BUCKETS;
+    int sub = (index - SUB_BUCKETS) % SUB_BUCKETS;
+    return static_cast<std::int64_t>(SUB_BUCKETS + sub) << shift;
+}
+
+std::int64_t LatencyHistogram::highestValueAt(int index) {
+    if (index < SUB_BUCKETS) {
+        return index;
+    }
+    int shift = (index - SUB_BUCKETS) / SUB_BUCKETS;
+    return lowestValueAt(index) + (std::int64_t(1) << shift) - 1;
+}
+
+void LatencyHistogram::record(std::int64_t value) {
+    if (value < 0) {
+        return;
+    }
+    counts[indexOf(value)].fetch_add(1, std::memory_order_relaxed);
+    totalCount.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(value, std::memory_order_relaxed);
+
+    std::int64_t currentMax = max.load(std::memory_order_relaxed);
+    while (value > currentMax && !max.compare_exchange_weak(currentMax, value, std::memory_order_relaxed)) {}
+}
+
+void LatencyHistogram::reset() {
+    for (auto& count : counts) {
+        count.store(0, std::memory_order_relaxed);
+    }
+    totalCount.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    max.store(0, std::memory_order_relaxed);
+}
+
+std::uint64_t LatencyHistogram::getCount() const {
+    return totalCount.load(std::memory_order_relaxed);
+}
+
+std::int64_t LatencyHistogram::getMax() const {
+    return max.load(std::memory_order_relaxed);
+}
+
+std::int64_t LatencyHistogram::getMean() const {
+    std::uint64_t n = getCount();
+    return n ? sum.load(std::memory_order_relaxed) / static_cast<std::int64_t>(n) : 0;
+}
+
+std::int64_t LatencyHistogram::valueAtPercentile(double percentile) const {
+    std::uint64_t total = getCount();
+    if (!total) {
+        return 0;
+    }
+    std::uint64_t target = static_cast<std::uint64_t>(percentile / 100.0 * total + 0.5);
+    if (target < 1) {
+        target = 1;
+    }
+    std::uint64_t seen = 0;
+    for (int i = 0; i < NB_BUCKETS; ++i) {
+        seen += counts[i].load(std::memory_order_relaxed);
+        if (seen >= target) {
+            return std::min(highestValueAt(i), getMax());
+        }
+    }
+    return getMax();
+}
+
+QString LatencyHistogram::summary() const {
+    if (!getCount()) {
+        return "no sample";
+    }
+    return QString("n=%1 mean=%2us p50=%3us p90=%4us p99=%5us p99.9=%6us max=%7us")
+            .arg(getCount())
+            .arg(getMean())
+            .arg(valueAtPercentile(50))
+            .arg(valueAtPercentile(90))
+            .arg(valueAtPercentile(99))
+            .arg(valueAtPercentile(99.9))
+            .arg(getMax());
+}
+
+void LatencyHistogram::writeCsv(std::ostream& out, const QString& label) const {
+    for (int i = 0; i < NB_BUCKETS; ++i) {
+        std::uint64_t count = counts[i].load(std::memory_order_relaxed);
+        if (count) {
+            out << label.toStdString() << ',' << lowestValueAt(i) << ',' << highestValueAt(i) << ',' << count << '\n';
+        }
+    }
+}
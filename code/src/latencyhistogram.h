@@ -0,0 +1,66 @@
+#ifndef LATENCYHISTOGRAM_H
+#define LATENCYHISTOGRAM_H
+
+#include <QString>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <ostream>
+
+/**
+ * @brief Histogramme de latences à la manière de HdrHistogram.
+ *        Chaque puissance de deux est découpée en SUB_BUCKETS intervalles linéaires, ce qui
+ *        garantit une erreur relative inférieure à 1 / SUB_BUCKETS sur toute la plage (1 µs .. 2^MAX_EXPONENT µs).
+ *        L'enregistrement ne fait que des incréments atomiques relâchés : aucun verrou n'est pris,
+ *        on peut donc enregistrer depuis n'importe quel thread, y compris dans une section critique.
+ */
+class LatencyHistogram {
+public:
+    static constexpr int SUB_BUCKET_BITS = 5;
+    static constexpr int SUB_BUCKETS = 1 << SUB_BUCKET_BITS;
+    static constexpr int MAX_EXPONENT = 40;
+    static constexpr int NB_BUCKETS = SUB_BUCKETS + (MAX_EXPONENT - SUB_BUCKET_BITS + 1) * SUB_BUCKETS;
+
+    /**
+     * @brief record
+     * Enregistre une valeur (µs). Les valeurs négatives sont ignorées, les trop grandes sont saturées.
+     */
+    void record(std::int64_t value);
+
+    void reset();
+
+    std::uint64_t getCount() const;
+    std::int64_t getMax() const;
+    std::int64_t getMean() const;
+
+    /**
+     * @brief valueAtPercentile
+     * @param percentile Le centile voulu, entre 0 et 100
+     * @return La borne haute de l'intervalle contenant ce centile
+     */
+    std::int64_t valueAtPercentile(double percentile) const;
+
+    /**
+     * @brief summary
+     * @return Une ligne résumant l'histogramme (nombre, moyenne, centiles, max) pour le rapport final.
+     */
+    QString summary() const;
+
+    /**
+     * @brief writeCsv
+     * Écrit une ligne "label,borne_basse_us,borne_haute_us,nombre" par intervalle non vide.
+     */
+    void writeCsv(std::ostream& out, const QString& label) const;
+
+    static int indexOf(std::int64_t value);
+    static std::int64_t lowestValueAt(int index);
+    static std::int64_t highestValueAt(int index);
+
+private:
+    std::array<std::atomic<std::uint64_t>, NB_BUCKETS> counts{};
+    std::atomic<std::uint64_t> totalCount{0};
+    std::atomic<std::int64_t> sum{0};
+    std::atomic<std::int64_t> max{0};
+};
+
+#endif // LATENCYHISTOGRAM_H
@@ -0,0 +1,102 @@
+#ifndef MAILBOX_H
+#define MAILBOX_H
+
+#include <atomic>
+#include <future>
+
+#include "itemcatalog.h"
+#include "patient.h"
+#include "shmring.h"
+
+/**
+ * @brief Maillon d'une MpscQueue, à placer en base des messages (file intrusive : aucune allocation par envoi).
+ */
+struct MpscNode {
+    std::atomic<MpscNode*> next{nullptr};
+};
+
+/**
+ * @brief File sans verrou, plusieurs producteurs et un seul consommateur (MPSC), intrusive.
+ *        push est sans attente (un échange atomique) ; pop, réservé au thread propriétaire,
+ *        peut renvoyer nullptr pendant qu'un dépôt est en cours : le message sera lu au prochain appel.
+ *        T doit dériver de MpscNode et survivre à son passage dans la file.
+ */
+template<typename T>
+class MpscQueue {
+public:
+    MpscQueue() : head(&stub), tail(&stub) {}
+
+    MpscQueue(const MpscQueue&) = delete;
+    MpscQueue& operator=(const MpscQueue&) = delete;
+
+    void push(T* message) { pushNode(message); }
+
+    T* pop() {
+        MpscNode* first = tail;
+        MpscNode* next = first->next.load(std::memory_order_acquire);
+        if (first == &stub) {
+            if (!next) {
+                return nullptr;
+            }
+            tail = next;
+            first = next;
+            next = next->next.load(std::memory_order_acquire);
+        }
+        if (next) {
+            tail = next;
+            return static_cast<T*>(first);
+        }
+
+        // Dernier message de la file : on remet le maillon fixe derrière lui avant de le sortir
+        if (first != head.load(std::memory_order_acquire)) {
+            return nullptr;
+        }
+        pushNode(&stub);
+        next = first->next.load(std::memory_order_acquire);
+        if (next) {
+            tail = next;
+            return static_cast<T*>(first);
+        }
+        return nullptr;
+    }
+
+private:
+    void pushNode(MpscNode* node) {
+        node->next.store(nullptr, std::memory_order_relaxed);
+        MpscNode* previous = head.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+    }
+
+    alignas(64) std::atomic<MpscNode*> head; // Dernier message déposé (producteurs)
+    alignas(64) MpscNode* tail;              // Prochain message lu (consommateur)
+    MpscNode stub;
+};
+
+/**
+ * @brief Nature d'un ordre : les deux transactions de Seller.
+ */
+enum class OrderKind { Request, Send };
+
+/**
+ * @brief Ordre déposé dans la boîte aux lettres d'un vendeur (cf. Seller::post), traité par le thread du vendeur.
+ *        L'ordre appartient à l'appelant, qui le garde jusqu'à la réponse.
+ */
+struct Order : MpscNode {
+    Order(OrderKind kind, ItemType item, int qty, int bill) : kind(kind), item(item), qty(qty), bill(bill) {}
+
+    OrderKind kind;
+    ItemType item;
+    int qty;
+    int bill;
+
+    // Fiches des patients transférés : celles de l'appelant à l'aller (send), celles du vendeur au retour (request)
+    PatientQueue parcel;
+
+    // Sonnette de l'appelant, sonnée après la réponse (nulle si personne n'attend sur une sonnette)
+    ShmDoorbell* replyBell = nullptr;
+
+    // Montant de la transaction, 0 si refusée. Fixé en dernier : l'appelant peut alors relire l'ordre et le libérer
+    std::promise<int> reply;
+};
+
+#endif // MAILBOX_H
@@ -0,0 +1,205 @@
+#include "patient.h"
+#include <chrono>
+#include <fstream>
+
+namespace {
+// Coursier propre à chaque thread : les fiches y transitent le temps d'un appel send/request
+thread_local PatientQueue courier;
+
+const auto epoch = std::chrono::steady_clock::now();
+}
+
+QString getStageName(PatientStage stage) {
+    switch (stage) {
+        case PatientStage::Ambulance : return "Ambulance";
+        case PatientStage::HospitalAdmission : return "Ambulance -> Hospital";
+        case PatientStage::ClinicTransfer : return "Hospital -> Clinic";
+        case PatientStage::Treated : return "Treatment";
+        case PatientStage::ReturnedToHospital : return "Clinic -> Hospital";
+        case PatientStage::Discharged : return "Discharge";
+        default : return "???";
+    }
+}
+
+std::int64_t PatientRecord::stamp(PatientStage stage) {
+    int index = static_cast<int>(stage);
+    timestamps[index] = PatientTracker::now();
+    if (index > 0 && timestamps[index - 1] >= 0) {
+        return timestamps[index] - timestamps[index - 1];
+    }
+    return -1;
+}
+
+PatientPool::PatientPool(std::size_t capacity)
+    : records(new PatientRecord[capacity]), capacity(capacity), head(capacity ? 1 : 0), nextId(0)
+{
+    for (std::size_t i = 0; i < capacity; ++i) {
+        records[i].next = nullptr;
+        records[i].nextFree.store(i + 1 < capacity ? i + 2 : 0, std::memory_order_relaxed);
+    }
+}
+
+PatientRecord* PatientPool::acquire() {
+    std::uint64_t old = head.load(std::memory_order_acquire);
+    for (;;) {
+        std::uint32_t index = old & 0xffffffffu;
+        if (index == 0) {
+            return nullptr;
+        }
+        PatientRecord* record = &records[index - 1];
+        std::uint64_t next = ((old >> 32) + 1) << 32 | record->nextFree.load(std::memory_order_relaxed);
+        if (head.compare_exchange_weak(old, next, std::memory_order_acq_rel, std::memory_order_acquire)) {
+            record->id = nextId.fetch_add(1, std::memory_order_relaxed);
+            record->timestamps.fill(-1);
+            record->next = nullptr;
+            return record;
+        }
+    }
+}
+
+void PatientPool::release(PatientRecord* record) {
+    std::uint32_t index = static_cast<std::uint32_t>(record - records.get()) + 1;
+    std::uint64_t old = head.load(std::memory_order_relaxed);
+    for (;;) {
+        record->nextFree.store(old & 0xffffffffu, std::memory_order_relaxed);
+        std::uint64_t next = ((old >> 32) + 1) << 32 | index;
+        if (head.compare_exchange_weak(old, next, std::memory_order_release, std::memory_order_relaxed)) {
+            return;
+        }
+    }
+}
+
+void PatientQueue::push(PatientRecord* record) {
+    record->next = nullptr;
+    if (tail) {
+        tail->next = record;
+    } else {
+        head = record;
+    }
+    tail = record;
+    ++count;
+}
+
+void PatientQueue::pushFront(PatientRecord* record) {
+    record->next = head;
+    head = record;
+    if (!tail) {
+        tail = record;
+    }
+    ++count;
+}
+
+PatientRecord* PatientQueue::pop() {
+    PatientRecord* record = head;
+    if (record) {
+        head = record->next;
+        if (!head) {
+            tail = nullptr;
+        }
+        record->next = nullptr;
+        --count;
+    }
+    return record;
+}
+
+PatientTracker::PatientTracker(std::size_t capacity) : pool(capacity) {}
+
+std::int64_t PatientTracker::now() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - epoch).count();
+}
+
+void PatientTracker::create(PatientQueue& queue, int qty) {
+    for (int i = 0; i < qty; ++i) {
+        PatientRecord* record = pool.acquire();
+        if (!record) {
+            return;
+        }
+        stamp(record, PatientStage::Ambulance);
+        queue.push(record);
+    }
+}
+
+void PatientTracker::handOver(PatientQueue& queue, int qty) {
+    for (int i = 0; i < qty && !queue.empty(); ++i) {
+        courier.push(queue.pop());
+    }
+}
+
+void PatientTracker::receive(PatientQueue& queue, PatientStage stage) {
+    while (PatientRecord* record = courier.pop()) {
+        stamp(record, stage);
+        queue.push(record);
+    }
+}
+
+void PatientTracker::takeBack(PatientQueue& queue) {
+    PatientQueue undelivered;
+    while (PatientRecord* record = courier.pop()) {
+        undelivered.pushFront(record);
+    }
+    while (PatientRecord* record = undelivered.pop()) {
+        queue.pushFront(record);
+    }
+}
+
+void PatientTracker::pack(PatientQueue& parcel) {
+    while (PatientRecord* record = courier.pop()) {
+        parcel.push(record);
+    }
+}
+
+void PatientTracker::unpack(PatientQueue& parcel) {
+    while (PatientRecord* record = parcel.pop()) {
+        courier.push(record);
+    }
+}
+
+void PatientTracker::advance(PatientQueue& from, PatientQueue& to, PatientStage stage, int qty) {
+    for (int i = 0; i < qty && !from.empty(); ++i) {
+        PatientRecord* record = from.pop();
+        stamp(record, stage);
+        to.push(record);
+    }
+}
+
+void PatientTracker::discharge(PatientQueue& queue, int qty) {
+    for (int i = 0; i < qty && !queue.empty(); ++i) {
+        PatientRecord* record = queue.pop();
+        stamp(record, PatientStage::Discharged);
+        histograms[0].record(record->timestamps[PATIENT_STAGE_COUNT - 1] - record->timestamps[0]);
+
+        pool.release(record);
+    }
+}
+
+void PatientTracker::stamp(PatientRecord* record, PatientStage stage) {
+    std::int64_t latency = record->stamp(stage);
+    if (latency >= 0) {
+        recordLatency(stage, latency);
+    }
+}
+
+void PatientTracker::recordLatency(PatientStage stage, std::int64_t micros) {
+    histograms[static_cast<int>(stage)].record(micros);
+}
+
+QString PatientTracker::report() const {
+    QString report = QString("Patient latency, end to end : %1\n").arg(histograms[0].summary());
+    for (int stage = 1; stage < PATIENT_STAGE_COUNT; ++stage) {
+        report += QString("  %1 : %2\n").arg(getStageName(static_cast<PatientStage>(stage))).arg(histograms[stage].summary());
+    }
+    return report;
+}
+
+bool PatientTracker::exportCsv(const QString& path) const {
+    std::ofstream out(path.toStdString());
+    if (!out) {
+        return false;
+    }
+    out << "stage,bucket_low_us,bucket_high_us,count\n";
+    histograms[0].writeCsv(out, "End to end");
+    for (int stage = 1; stage < PATIENT_STAGE_COUNT; ++stage) {
+        histograms[stage].writeCsv(out, getStageName(static_cast<PatientStage>(stage)));
+    }
+    return static_cast<bool>(out);
+}
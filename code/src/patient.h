@@ -0,0 +1,190 @@
+#ifndef PATIENT_H
+#define PATIENT_H
+
+#include <QString>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+
+#include "latencyhistogram.h"
+
+/**
+ * @brief Étapes successives du parcours d'un patient, dans l'ordre.
+ *        Ambulance : le patient attend dans une ambulance (début du parcours).
+ *        HospitalAdmission : admis à l'hôpital depuis une ambulance (Hospital::send).
+ *        ClinicTransfer : transféré de l'hôpital vers une clinique (Hospital::request).
+ *        Treated : soigné par la clinique (Clinic::treatPatient).
+ *        ReturnedToHospital : revenu à l'hôpital depuis la clinique (Hospital::transferPatientsFromClinic).
+ *        Discharged : sorti de l'hôpital (Hospital::freeHealedPatient).
+ */
+enum class PatientStage {
+    Ambulance, HospitalAdmission, ClinicTransfer, Treated, ReturnedToHospital, Discharged, Count
+};
+
+constexpr int PATIENT_STAGE_COUNT = static_cast<int>(PatientStage::Count);
+
+QString getStageName(PatientStage stage);
+
+/**
+ * @brief Fiche d'un patient : identifiant et horodatage (µs) de chaque étape atteinte.
+ *        Les fiches sont préallouées par le PatientPool et chaînées de manière intrusive.
+ */
+struct PatientRecord {
+    unsigned int id;
+    std::array<std::int64_t, PATIENT_STAGE_COUNT> timestamps;
+
+    PatientRecord* next;             // Chaînage dans une PatientQueue
+    std::atomic<std::uint32_t> nextFree; // Chaînage dans la pile libre du pool (indice + 1, 0 = fin)
+
+    /**
+     * @brief stamp
+     * Horodate l'étape donnée.
+     * @return La durée (µs) depuis l'étape précédente, -1 si celle-ci n'a pas été atteinte
+     */
+    std::int64_t stamp(PatientStage stage);
+};
+
+/**
+ * @brief Pool de fiches patients sans verrou.
+ *        Toutes les fiches sont allouées à la construction ; acquire/release ne font
+ *        qu'empiler/dépiler sur une pile de Treiber dont la tête porte un compteur (anti-ABA).
+ */
+class PatientPool {
+public:
+    explicit PatientPool(std::size_t capacity);
+
+    /**
+     * @brief acquire
+     * @return Une fiche réinitialisée, ou nullptr si le pool est épuisé.
+     */
+    PatientRecord* acquire();
+
+    /**
+     * @brief release
+     * Rend une fiche au pool.
+     */
+    void release(PatientRecord* record);
+
+private:
+    std::unique_ptr<PatientRecord[]> records;
+    std::size_t capacity;
+    std::atomic<std::uint64_t> head; // (compteur << 32) | (indice + 1)
+    std::atomic<unsigned int> nextId;
+};
+
+/**
+ * @brief File FIFO intrusive de fiches patients.
+ *        Pas de synchronisation interne : la file est protégée par le mutex du vendeur qui la possède.
+ */
+class PatientQueue {
+public:
+    void push(PatientRecord* record);
+    void pushFront(PatientRecord* record);
+    PatientRecord* pop();
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+
+private:
+    PatientRecord* head = nullptr;
+    PatientRecord* tail = nullptr;
+    std::size_t count = 0;
+};
+
+/**
+ * @brief Suivi optionnel des patients individuels d'une simulation, possédé par son Utils.
+ *        Les fiches passent d'un vendeur à l'autre dans le même thread que l'appel send/request :
+ *        l'appelant (ou l'appelé) dépose les fiches dans un coursier local au thread, l'autre partie
+ *        les récupère dans sa section critique. Sans suivi, les vendeurs n'ont pas de tracker (cf. Seller::setPatientTracker).
+ */
+class PatientTracker {
+public:
+    /**
+     * @brief PatientTracker
+     * Préalloue un pool de capacity fiches. À créer avant le lancement des vendeurs qui l'utilisent.
+     */
+    explicit PatientTracker(std::size_t capacity);
+
+    /**
+     * @brief create
+     * Crée qty nouvelles fiches (étape Ambulance) dans la file donnée.
+     */
+    void create(PatientQueue& queue, int qty);
+
+    /**
+     * @brief handOver
+     * Retire qty fiches de la file et les confie au coursier du thread courant.
+     */
+    void handOver(PatientQueue& queue, int qty);
+
+    /**
+     * @brief receive
+     * Récupère les fiches du coursier, les horodate pour l'étape donnée et les ajoute à la file.
+     */
+    void receive(PatientQueue& queue, PatientStage stage);
+
+    /**
+     * @brief takeBack
+     * Remet en tête de file les fiches que le coursier n'a pas pu livrer (transfert refusé).
+     */
+    void takeBack(PatientQueue& queue);
+
+    /**
+     * @brief pack
+     * Vide le coursier du thread courant dans un colis, qui voyage avec un ordre vers un autre thread (cf. Order).
+     */
+    static void pack(PatientQueue& parcel);
+
+    /**
+     * @brief unpack
+     * Remet un colis dans le coursier du thread courant, comme si les fiches avaient été confiées dans ce thread.
+     */
+    static void unpack(PatientQueue& parcel);
+
+    /**
+     * @brief advance
+     * Passe qty fiches d'une file à l'autre en les horodatant (ex. patient soigné dans la clinique).
+     */
+    void advance(PatientQueue& from, PatientQueue& to, PatientStage stage, int qty);
+
+    /**
+     * @brief discharge
+     * Sort qty fiches de la file, enregistre leurs latences par étape et les rend au pool.
+     */
+    void discharge(PatientQueue& queue, int qty);
+
+    /**
+     * @brief recordLatency
+     * Enregistre la durée passée pour atteindre une étape depuis l'étape précédente (sans verrou).
+     * PatientStage::Ambulance désigne le parcours complet, de l'ambulance à la sortie.
+     */
+    void recordLatency(PatientStage stage, std::int64_t micros);
+
+    /**
+     * @brief report
+     * @return Les histogrammes de latence par étape, pour le rapport final.
+     */
+    QString report() const;
+
+    /**
+     * @brief exportCsv
+     * Écrit les histogrammes de chaque étape au format CSV (stage,bucket_low_us,bucket_high_us,count).
+     * @return true si le fichier a pu être écrit.
+     */
+    bool exportCsv(const QString& path) const;
+
+    static std::int64_t now();
+
+private:
+    /**
+     * @brief stamp
+     * Horodate la fiche pour l'étape donnée et enregistre la durée depuis l'étape précédente si elle a été atteinte.
+     */
+    void stamp(PatientRecord* record, PatientStage stage);
+
+    PatientPool pool;
+    std::array<LatencyHistogram, PATIENT_STAGE_COUNT> histograms; // [0] : parcours complet
+};
+
+#endif // PATIENT_H
@@ -0,0 +1,225 @@
+#include "placement.h"
+#include <algorithm>
+#include <fstream>
+#include <queue>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <pthread.h>
+#include <sched.h>
+
+namespace {
+
+// Groupe du thread courant, publié par pinCurrentThread
+thread_local int threadGroup = -1;
+
+// Lit une liste de CPU au format du noyau ("0-3,8,10-11")
+std::vector<int> readCpuList(const std::string& path) {
+    std::vector<int> cpus;
+    std::ifstream in(path);
+    std::string line;
+    if (!in || !std::getline(in, line)) {
+        return cpus;
+    }
+
+    std::stringstream ranges(line);
+    std::string range;
+    while (std::getline(ranges, range, ',')) {
+        if (range.empty()) {
+            continue;
+        }
+        size_t dash = range.find('-');
+        int first = std::stoi(range.substr(0, dash));
+        int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+        for (int cpu = first; cpu <= last; ++cpu) {
+            cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
+
+}
+
+CpuTopology CpuTopology::detect(int nbGroups) {
+    CpuTopology topology;
+
+    // Nœuds NUMA d'abord : c'est là que le coût d'un accès distant est le plus élevé
+    for (int node = 0; node < 1024; ++node) {
+        std::vector<int> cpus = readCpuList("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+        if (!cpus.empty()) {
+            topology.groups.push_back(cpus);
+        }
+    }
+
+    // Un seul nœud : on regroupe par cache L3 partagé
+    if (topology.groups.size() < 2) {
+        topology.groups.clear();
+        int nbCpus = std::max(1u, std::thread::hardware_concurrency());
+        for (int cpu = 0; cpu < nbCpus; ++cpu) {
+            std::vector<int> shared = readCpuList("/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/cache/index3/shared_cpu_list");
+            if (!shared.empty() && std::find(topology.groups.begin(), topology.groups.end(), shared) == topology.groups.end()) {
+                topology.groups.push_back(shared);
+            }
+        }
+        if (topology.groups.empty()) {
+            std::vector<int> all(nbCpus);
+            for (int cpu = 0; cpu < nbCpus; ++cpu) {
+                all[cpu] = cpu;
+            }
+            topology.groups.push_back(all);
+        }
+    }
+
+    if (nbGroups <= 0 || nbGroups == int(topology.groups.size())) {
+        return topology;
+    }
+
+    // Nombre de groupes imposé : on redécoupe la liste des CPU en tranches contiguës,
+    // ce qui garde ensemble les CPU d'un même nœud autant que possible
+    std::vector<int> all;
+    for (const auto& group : topology.groups) {
+        all.insert(all.end(), group.begin(), group.end());
+    }
+    topology.groups.assign(nbGroups, {});
+    for (int g = 0; g < nbGroups; ++g) {
+        size_t begin = all.size() * g / nbGroups;
+        size_t end = all.size() * (g + 1) / nbGroups;
+        if (begin == end) {
+            // Moins de CPU que de groupes : les groupes se partagent les CPU
+            topology.groups[g].push_back(all[begin % all.size()]);
+        } else {
+            topology.groups[g].assign(all.begin() + begin, all.begin() + end);
+        }
+    }
+    return topology;
+}
+
+ActorPlacement::ActorPlacement(int nbActors, int nbGroups)
+    : nbActors(nbActors), nbGroups(std::max(1, nbGroups)), links(nbActors) {}
+
+void ActorPlacement::addLink(int a, int b) {
+    if (a == b || a < 0 || b < 0 || a >= nbActors || b >= nbActors) {
+        return;
+    }
+    links[a].push_back(b);
+    links[b].push_back(a);
+}
+
+std::vector<int> ActorPlacement::spread() const {
+    std::vector<int> layout(nbActors);
+    for (int actor = 0; actor < nbActors; ++actor) {
+        layout[actor] = actor % nbGroups;
+    }
+    return layout;
+}
+
+std::vector<int> ActorPlacement::clustered() const {
+    std::vector<int> layout(nbActors, -1);
+    int placed = 0;
+
+    // Files de priorité à suppression paresseuse : une entrée dont l'acteur est déjà placé (ou dont l'affinité
+    // a changé depuis) est simplement ignorée quand elle arrive en tête. Les clés reprennent l'ordre du choix
+    // glouton, à égalité le plus petit identifiant l'emporte.
+    using Key = std::tuple<int, int, int>;
+    auto degree = [this](int actor) { return int(links[actor].size()); };
+
+    // Graine : l'acteur le plus connecté, il attirera ses voisins
+    std::priority_queue<Key> seeds;
+    // Acteurs sans lien vers le groupe : le moins connecté ailleurs d'abord
+    std::priority_queue<Key> loners;
+    for (int actor = 0; actor < nbActors; ++actor) {
+        seeds.emplace(degree(actor), -actor, 0);
+        loners.emplace(-degree(actor), -actor, 0);
+    }
+    auto popFree = [&layout](std::priority_queue<Key>& heap) {
+        while (layout[-std::get<1>(heap.top())] != -1) {
+            heap.pop();
+        }
+        return -std::get<1>(heap.top());
+    };
+
+    for (int group = 0; group < nbGroups && placed < nbActors; ++group) {
+        // Part équilibrée du groupe : les premiers groupes prennent l'éventuel reste
+        int capacity = nbActors / nbGroups + (group < nbActors % nbGroups ? 1 : 0);
+
+        // Nombre de liens de chaque acteur libre vers le groupe en construction, et candidats classés par
+        // affinité puis, à affinité égale, par nombre de liens hors du groupe
+        std::vector<int> affinity(nbActors, 0);
+        std::priority_queue<Key> candidates;
+
+        for (int size = 0; size < capacity; ++size) {
+            while (!candidates.empty()) {
+                int actor = -std::get<2>(candidates.top());
+                if (layout[actor] == -1 && std::get<0>(candidates.top()) == affinity[actor]) {
+                    break;
+                }
+                candidates.pop();
+            }
+
+            int best;
+            if (size == 0) {
+                best = popFree(seeds);
+            } else if (!candidates.empty()) {
+                best = -std::get<2>(candidates.top());
+            } else {
+                best = popFree(loners);
+            }
+
+            layout[best] = group;
+            ++placed;
+            for (int neighbour : links[best]) {
+                if (layout[neighbour] == -1) {
+                    ++affinity[neighbour];
+                    candidates.emplace(affinity[neighbour], affinity[neighbour] - degree(neighbour), -neighbour);
+                }
+            }
+        }
+    }
+    return layout;
+}
+
+int ActorPlacement::crossGroupLinks(const std::vector<int>& layout) const {
+    int crossing = 0;
+    for (int actor = 0; actor < nbActors; ++actor) {
+        for (int neighbour : links[actor]) {
+            if (actor < neighbour && layout[actor] != layout[neighbour]) {
+                ++crossing;
+            }
+        }
+    }
+    return crossing;
+}
+
+int ActorPlacement::getNbLinks() const {
+    int total = 0;
+    for (const auto& neighbours : links) {
+        total += int(neighbours.size());
+    }
+    return total / 2;
+}
+
+bool ActorPlacement::pinCurrentThread(const std::vector<int>& cpus, int group) {
+    threadGroup = group;
+
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        if (cpu >= 0 && cpu < CPU_SETSIZE) {
+            CPU_SET(cpu, &set);
+        }
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+int ActorPlacement::currentGroup() {
+    return threadGroup;
+}
+
+QString ActorPlacement::modeName(PlacementMode mode) {
+    switch (mode) {
+        case PlacementMode::Spread: return "spread";
+        case PlacementMode::Clustered: return "clustered";
+        default: return "none";
+    }
+}
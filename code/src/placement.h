@@ -0,0 +1,99 @@
+#ifndef PLACEMENT_H
+#define PLACEMENT_H
+
+#include <QString>
+#include <vector>
+
+/**
+ * @brief Mode de placement des threads des acteurs sur les processeurs.
+ *        None : aucun épinglage (comportement historique, l'ordonnanceur décide) ;
+ *        Spread : acteurs répartis à tour de rôle sur les groupes de cœurs, sans tenir compte des liens
+ *                 (disposition de référence pour comparer le trafic) ;
+ *        Clustered : acteurs qui commercent ensemble regroupés sur le même groupe de cœurs.
+ */
+enum class PlacementMode { None, Spread, Clustered };
+
+/**
+ * @brief Topologie des processeurs : la liste des CPU de chaque groupe (nœud NUMA, à défaut cache L3 partagé).
+ */
+struct CpuTopology {
+    std::vector<std::vector<int>> groups;
+
+    /**
+     * @brief detect
+     * Lit la topologie dans /sys. Sans information exploitable, un seul groupe contenant tous les CPU.
+     * @param nbGroups Nombre de groupes voulu (0 : ceux de la machine). Sinon, la liste de tous les CPU est
+     *        redécoupée en exactement nbGroups tranches contiguës ; s'il y a moins de CPU que de groupes,
+     *        des groupes partagent le même CPU
+     */
+    static CpuTopology detect(int nbGroups = 0);
+};
+
+/**
+ * @brief Placement des acteurs sur les groupes de cœurs, calculé à partir du graphe des liens commerciaux
+ *        (setClinics, setHospitals, setHospitalsAndSuppliers).
+ *
+ * Les acteurs sont identifiés par leur uniqueId (0 .. nbActors - 1). Chaque thread épinglé publie son groupe
+ * dans une variable locale au thread, ce qui permet aux vendeurs de compter les transactions reçues d'un autre groupe.
+ *
+ * Le graphe ne dépend que des identifiants : Utils le déclare et calcule la disposition avant de construire les
+ * acteurs, puis construit ceux de chaque groupe depuis un thread épinglé sur ce groupe, dans une arène propre au
+ * groupe. La politique « first touch » du noyau place alors l'état des acteurs (vendeurs, stocks initiaux) sur le
+ * nœud local ; l'épinglage seul ne déplacerait pas la mémoire déjà allouée.
+ */
+class ActorPlacement {
+public:
+    ActorPlacement(int nbActors, int nbGroups);
+
+    /**
+     * @brief addLink
+     * Déclare que deux acteurs commercent ensemble (lien non orienté, les doublons renforcent le lien).
+     */
+    void addLink(int a, int b);
+
+    /**
+     * @brief spread
+     * @return Le groupe de chaque acteur, attribué à tour de rôle
+     */
+    std::vector<int> spread() const;
+
+    /**
+     * @brief clustered
+     * Regroupement glouton : chaque groupe part de l'acteur libre le plus connecté, puis ajoute l'acteur libre
+     * ayant le plus de liens vers le groupe, jusqu'à remplir sa part (les groupes restent équilibrés).
+     * Les candidats sont tenus dans des files de priorité : O(L log L) pour L liens.
+     * @return Le groupe de chaque acteur
+     */
+    std::vector<int> clustered() const;
+
+    /**
+     * @brief crossGroupLinks
+     * @return Le nombre de liens dont les deux extrémités sont dans des groupes différents
+     */
+    int crossGroupLinks(const std::vector<int>& layout) const;
+
+    int getNbLinks() const;
+    int getNbGroups() const { return nbGroups; }
+
+    /**
+     * @brief pinCurrentThread
+     * Épingle le thread appelant sur les CPU du groupe et publie le groupe pour currentGroup().
+     * @return false si l'affinité n'a pas pu être appliquée (le groupe est tout de même publié)
+     */
+    static bool pinCurrentThread(const std::vector<int>& cpus, int group);
+
+    /**
+     * @brief currentGroup
+     * @return Le groupe du thread appelant, -1 s'il n'a pas été épinglé
+     */
+    static int currentGroup();
+
+    static QString modeName(PlacementMode mode);
+
+private:
+    int nbActors;
+    int nbGroups;
+    std::vector<std::vector<int>> links; // Liste d'adjacence, un voisin par lien
+};
+
+#endif // PLACEMENT_H
@@ -0,0 +1,185 @@
+#include "replay.h"
+#include <pcosynchro/pcomutex.h>
+#include <pcosynchro/pcoconditionvariable.h>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+
+const char MAGIC[4] = {'P', 'C', 'O', 'R'};
+const std::uint8_t VERSION = 1;
+
+void writeVarint(std::ostream& out, std::uint64_t value) {
+    while (value >= 0x80) {
+        out.put(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.put(static_cast<char>(value));
+}
+
+bool readVarint(std::istream& in, std::uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int byte = in.get();
+        if (byte == EOF) {
+            return false;
+        }
+        value |= std::uint64_t(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+}
+
+PcoConditionVariable& Replay::turnOf(int actorId) {
+    auto& turn = turns[actorId];
+    if (!turn) {
+        turn = std::make_unique<PcoConditionVariable>();
+    }
+    return *turn;
+}
+
+void Replay::wakeNext() {
+    if (cursor < steps.size()) {
+        turnOf(steps[cursor]).notifyOne();
+    } else {
+        for (auto& turn : turns) {
+            turn.second->notifyAll();
+        }
+    }
+}
+
+std::unique_ptr<Replay> Replay::record(const QString& path) {
+    std::unique_ptr<Replay> replay(new Replay(Mode::Record));
+    replay->recordPath = path;
+    return replay;
+}
+
+std::unique_ptr<Replay> Replay::load(const QString& path) {
+    std::ifstream in(path.toStdString(), std::ios::binary);
+    char magic[sizeof(MAGIC)];
+    if (!in.read(magic, sizeof(magic)) || !std::equal(std::begin(magic), std::end(magic), MAGIC) || in.get() != VERSION) {
+        return nullptr;
+    }
+
+    std::unique_ptr<Replay> replay(new Replay(Mode::Replay));
+    std::uint64_t count, id, value;
+
+    if (!readVarint(in, count)) {
+        return nullptr;
+    }
+    for (std::uint64_t i = 0; i < count; ++i) {
+        if (!readVarint(in, id) || !readVarint(in, value)) {
+            return nullptr;
+        }
+        replay->seeds[static_cast<int>(id)] = static_cast<std::uint32_t>(value);
+    }
+    if (!readVarint(in, count)) {
+        return nullptr;
+    }
+    replay->steps.reserve(count);
+    for (std::uint64_t i = 0; i < count; ++i) {
+        if (!readVarint(in, id)) {
+            return nullptr;
+        }
+        replay->steps.push_back(static_cast<int>(id));
+    }
+    return replay;
+}
+
+bool Replay::finish() {
+    bool ok = true;
+
+    stateMutex.lock();
+    if (mode == Mode::Record) {
+        std::ofstream out(recordPath.toStdString(), std::ios::binary);
+        out.write(MAGIC, sizeof(MAGIC));
+        out.put(static_cast<char>(VERSION));
+        writeVarint(out, seeds.size());
+        for (const auto& seed : seeds) {
+            writeVarint(out, seed.first);
+            writeVarint(out, seed.second);
+        }
+        writeVarint(out, steps.size());
+        for (int id : steps) {
+            writeVarint(out, id);
+        }
+        ok = static_cast<bool>(out);
+    }
+    stateMutex.unlock();
+
+    return ok;
+}
+
+void Replay::abort() {
+    stateMutex.lock();
+    aborted = true;
+    for (auto& turn : turns) {
+        turn.second->notifyAll();
+    }
+    stateMutex.unlock();
+}
+
+std::uint32_t Replay::seedFor(int actorId) {
+    std::uint32_t seed;
+
+    stateMutex.lock();
+    if (mode == Mode::Replay) {
+        seed = seeds[actorId];
+    } else {
+        seed = std::random_device{}();
+        seeds[actorId] = seed;
+    }
+    stateMutex.unlock();
+
+    return seed;
+}
+
+std::size_t Replay::getStepCount() {
+    stateMutex.lock();
+    std::size_t count = mode == Mode::Replay ? cursor : steps.size();
+    stateMutex.unlock();
+    return count;
+}
+
+ReplayStep::ReplayStep(Replay* replay, int actorId) : replay(replay), allowed(true), held(false) {
+    if (!replay) {
+        return;
+    }
+    if (replay->isRecording()) {
+        replay->stepMutex.lock();
+        replay->stateMutex.lock();
+        replay->steps.push_back(actorId);
+        replay->stateMutex.unlock();
+        held = true;
+    } else {
+        replay->stateMutex.lock();
+        while (!replay->aborted && replay->cursor < replay->steps.size() && replay->steps[replay->cursor] != actorId) {
+            replay->turnOf(actorId).wait(&replay->stateMutex);
+        }
+        allowed = !replay->aborted && replay->cursor < replay->steps.size();
+        held = allowed;
+        replay->stateMutex.unlock();
+    }
+}
+
+ReplayStep::~ReplayStep() {
+    if (!held) {
+        return;
+    }
+    if (replay->isRecording()) {
+        replay->stepMutex.unlock();
+    } else {
+        replay->stateMutex.lock();
+        ++replay->cursor;
+        replay->wakeNext();
+        replay->stateMutex.unlock();
+    }
+}
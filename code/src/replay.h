@@ -0,0 +1,124 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include <QString>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <vector>
+#include <pcosynchro/pcomutex.h>
+#include <pcosynchro/pcoconditionvariable.h>
+
+/**
+ * @brief Enregistrement et rejeu déterministe d'une simulation.
+ *
+ * En mode enregistrement, chaque itération d'un acteur (ReplayStep) s'exécute en exclusion
+ * mutuelle avec celles des autres acteurs et l'identifiant de l'acteur est journalisé : on obtient
+ * un ordre total des transactions. Les tirages aléatoires des acteurs proviennent d'un générateur
+ * propre à chaque vendeur dont la graine est elle aussi journalisée.
+ *
+ * En mode rejeu, les graines sont relues et chaque acteur attend son tour dans le journal avant
+ * d'exécuter son itération : les transactions se déroulent dans le même ordre, sans attente simulée.
+ * Lorsque le journal est épuisé, les acteurs s'arrêtent d'eux-mêmes.
+ *
+ * Un enregistrement ou un rejeu appartient à une seule simulation : son Utils le possède, le confie à ses
+ * vendeurs et est le seul à l'interrompre ou à le terminer. Les autres simulations du processus n'en voient rien.
+ */
+class Replay {
+public:
+    /**
+     * @brief record
+     * Prépare l'enregistrement d'une simulation, à confier à son Utils avant la création des vendeurs.
+     * @param path Fichier dans lequel le journal sera écrit par finish()
+     */
+    static std::unique_ptr<Replay> record(const QString& path);
+
+    /**
+     * @brief load
+     * Charge un journal pour le rejouer, à confier à l'Utils de la simulation rejouée.
+     * @return nullptr si le fichier est illisible ou invalide
+     */
+    static std::unique_ptr<Replay> load(const QString& path);
+
+    /**
+     * @brief finish
+     * Termine l'enregistrement ou le rejeu ; en enregistrement, écrit le journal sur disque.
+     * @return false si le journal n'a pas pu être écrit
+     */
+    bool finish();
+
+    /**
+     * @brief abort
+     * Débloque les acteurs qui attendent leur tour (demande d'arrêt pendant un rejeu).
+     */
+    void abort();
+
+    bool isRecording() const { return mode == Mode::Record; }
+    bool isReplaying() const { return mode == Mode::Replay; }
+
+    /**
+     * @brief seedFor
+     * @return La graine du générateur aléatoire de l'acteur (enregistrée ou rejouée selon le mode)
+     */
+    std::uint32_t seedFor(int actorId);
+
+    /**
+     * @brief getStepCount
+     * @return Le nombre d'itérations journalisées (enregistrement) ou rejouées (rejeu)
+     */
+    std::size_t getStepCount();
+
+private:
+    friend class ReplayStep;
+
+    enum class Mode { Record, Replay };
+
+    explicit Replay(Mode mode) : mode(mode) {}
+
+    /**
+     * @brief wakeNext
+     * Rejeu : réveille l'acteur de l'itération suivante, ou tous les acteurs si le journal est épuisé.
+     * À appeler avec stateMutex verrouillé.
+     */
+    void wakeNext();
+    PcoConditionVariable& turnOf(int actorId);
+
+    // Fixé à la création : lu sans verrou par tous les acteurs
+    const Mode mode;
+    QString recordPath;
+
+    std::map<int, std::uint32_t> seeds;
+    std::vector<int> steps;
+    std::size_t cursor = 0;
+    bool aborted = false;
+
+    PcoMutex stepMutex;  // Enregistrement : sérialise les itérations des acteurs
+    PcoMutex stateMutex; // Protège seeds, steps, cursor et aborted
+    std::map<int, std::unique_ptr<PcoConditionVariable>> turns; // Rejeu : une condition par acteur
+};
+
+/**
+ * @brief Itération d'un acteur, à placer autour des transactions d'un tour de boucle (pas autour de l'attente simulée).
+ *        Sans enregistrement ni rejeu (replay nul), ne fait rien.
+ */
+class ReplayStep {
+public:
+    ReplayStep(Replay* replay, int actorId);
+    ~ReplayStep();
+
+    ReplayStep(const ReplayStep&) = delete;
+    ReplayStep& operator=(const ReplayStep&) = delete;
+
+    /**
+     * @brief proceed
+     * @return false si l'acteur doit s'arrêter (journal de rejeu épuisé ou rejeu interrompu)
+     */
+    bool proceed() const { return allowed; }
+
+private:
+    Replay* replay;
+    bool allowed;
+    bool held;
+};
+
+#endif // REPLAY_H
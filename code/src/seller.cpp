@@ -1,14 +1,18 @@
 #include "seller.h"
+#include "iwindowinterface.h"
 #include <algorithm>
 #include <random>
 #include <cassert>
+#include <chrono>
+#include <thread>
 
-Seller *Seller::chooseRandomSeller(std::vector<Seller *> &sellers) {
+// Garde-fou de l'attente d'une réponse : chaque réponse sonne la sonnette de l'appelant, l'attente n'expire
+// donc pas en fonctionnement normal
+static constexpr unsigned REPLY_WAIT_US = 100000;
+
+Seller *Seller::chooseRandomSeller(SellerList sellers, std::mt19937 &rng) {
     assert(sellers.size());
-    std::vector<Seller*> out;
-    std::sample(sellers.begin(), sellers.end(), std::back_inserter(out),
-            1, std::mt19937{std::random_device{}()});
-    return out.front();
+    return sellers[rng() % sellers.size()];
 }
 
 ItemType Seller::chooseRandomItem(std::map<ItemType, int> &itemsForSale) {
@@ -21,51 +25,103 @@ ItemType Seller::chooseRandomItem(std::map<ItemType, int> &itemsForSale) {
     return out.front().first;
 }
 
-int getCostPerUnit(ItemType item) {
-    switch (item) {
-        case ItemType::Syringe : return SYRINGUE_COST;
-        case ItemType::Pill : return PILL_COST;
-        case ItemType::Scalpel : return SCALPEL_COST;
-        case ItemType::Thermometer : return THERMOMETER_COST;
-        case ItemType::Stethoscope : return STETHOSCOPE_COST;
-        case ItemType::PatientHealed : return HEALING_COST;
-        case ItemType::PatientSick : return TRANSFER_COST;
-        default : return 0;
+const QString& getItemName(ItemType item) {
+    // Noms construits une seule fois, au premier appel (initialisation thread-safe)
+    static const std::array<QString, ITEM_CATALOG.size()> names = [] {
+        std::array<QString, ITEM_CATALOG.size()> built;
+        for (const ItemInfo& info : ITEM_CATALOG) {
+            built[itemIndex(info.type)] = QString(info.name);
+        }
+        return built;
+    }();
+    return isCatalogItem(item) ? names[itemIndex(item)] : ItemRegistry::get(item).name;
+}
+
+std::future<int> Seller::post(Order& order) {
+    std::future<int> reply = order.reply.get_future();
+
+    posting.fetch_add(1);
+    if (inboxClosed.load()) {
+        posting.fetch_sub(1);
+        order.reply.set_value(0);
+        return reply;
+    }
+    inbox.push(&order);
+    posting.fetch_sub(1);
+    inboxBell.ring();
+    return reply;
+}
+
+int Seller::trade(Seller* seller, OrderKind kind, ItemType item, int qty, int bill) {
+    if (!seller->hasInbox()) {
+        return kind == OrderKind::Send ? seller->send(item, qty, bill) : seller->request(item, qty);
+    }
+
+    Order order(kind, item, qty, bill);
+    order.replyBell = &inboxBell;
+    PatientTracker::pack(order.parcel);
+    std::future<int> reply = seller->post(order);
+    int amount = awaitReply(reply);
+    PatientTracker::unpack(order.parcel);
+    return amount;
+}
+
+int Seller::awaitReply(std::future<int>& reply) {
+    // Sonnerie lue avant de vérifier : un ordre ou la réponse arrivés entre-temps réveillent aussitôt
+    for (;;) {
+        std::uint32_t seen = inboxBell.sequence();
+        serveOrders();
+        if (reply.wait_for(std::chrono::seconds(0)) == std::future_status::ready) {
+            return reply.get();
+        }
+        inboxBell.wait(seen, REPLY_WAIT_US);
     }
 }
 
-QString getItemName(ItemType item) {
-    switch (item) {
-        case ItemType::Syringe : return "Syringe";
-        case ItemType::Pill : return "Pill";
-        case ItemType::Scalpel : return "Scalpel";
-        case ItemType::Thermometer : return "Thermometer";
-        case ItemType::Stethoscope : return "Stethoscope";
-        case ItemType::PatientHealed : return "Patient Healed";
-        case ItemType::PatientSick : return "Patient Sick";
-        case ItemType::Nothing : return "Nothing";
-        default : return "???";
+void Seller::serveOrders() {
+    while (Order* order = inbox.pop()) {
+        // Les fiches de l'appelant arrivent dans le coursier de ce thread, celles confiées en retour repartent avec l'ordre
+        PatientTracker::unpack(order->parcel);
+        int amount = order->kind == OrderKind::Send ? send(order->item, order->qty, order->bill)
+                                                    : request(order->item, order->qty);
+        PatientTracker::pack(order->parcel);
+        reply(order, amount);
     }
 }
 
-EmployeeType getEmployeeThatProduces(ItemType item) {
-    switch (item) {
-        case ItemType::Syringe : /* fallthrough */
-        case ItemType::Pill : /* fallthrough */
-        case ItemType::Scalpel : /* fallthrough */
-        case ItemType::Thermometer : /* fallthrough */
-        case ItemType::PatientSick : /* fallthrough */
-        case ItemType::Stethoscope : return EmployeeType::Supplier;
-        case ItemType::PatientHealed : return EmployeeType::Doctor;
-        default : return EmployeeType::Nurse;
+void Seller::reply(Order* order, int amount) {
+    // La sonnette est lue avant la réponse : l'appelant peut libérer l'ordre dès qu'elle est fixée
+    ShmDoorbell* bell = order->replyBell;
+    order->reply.set_value(amount);
+    if (bell) {
+        bell->ring();
     }
 }
 
-int getEmployeeSalary(EmployeeType employee) {
-    switch (employee) {
-        case EmployeeType::Nurse : return NURSE_COST;
-        case EmployeeType::Supplier : return SUPPLIER_COST;
-        case EmployeeType::Doctor : return DOCTOR_COST;
-        default : return 0;
+void Seller::workServingOrders() {
+    if (!inboxEnabled) {
+        interface->simulateWork();
+        return;
+    }
+
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::microseconds(interface->workDuration());
+    for (;;) {
+        std::uint32_t seen = inboxBell.sequence();
+        serveOrders();
+        auto remaining = std::chrono::duration_cast<std::chrono::microseconds>(deadline - std::chrono::steady_clock::now());
+        if (remaining.count() <= 0) {
+            return;
+        }
+        inboxBell.wait(seen, unsigned(remaining.count()));
+    }
+}
+
+void Seller::closeInbox() {
+    inboxClosed.store(true);
+    while (posting.load()) {
+        std::this_thread::yield();
+    }
+    while (Order* order = inbox.pop()) {
+        reply(order, 0);
     }
 }
@@ -3,30 +3,69 @@
 
 #include <QString>
 #include <QStringBuilder>
+#include <array>
+#include <atomic>
+#include <future>
 #include <map>
+#include <random>
 #include <vector>
 #include <pcosynchro/pcomutex.h>
-#include "costs.h"
+#include "actorscheduler.h"
+#include "itemcatalog.h"
+#include "itemregistry.h"
+#include "mailbox.h"
+#include "patient.h"
+#include "placement.h"
+#include "replay.h"
+#include "shmring.h"
 
-enum class ItemType {
-    PatientSick, PatientHealed, Syringe, Pill, Scalpel, Thermometer, Stethoscope, Nothing
-};
+class IWindowInterface;
+
+// Taille d'une ligne de cache : sépare l'état modifié par d'autres threads du reste des objets.
+// Peut être réduite à la compilation (ex. -DCACHE_LINE_SIZE=8) pour mesurer l'effet du faux partage
+#ifndef CACHE_LINE_SIZE
+#define CACHE_LINE_SIZE 64
+#endif
 
-int getCostPerUnit(ItemType item);
-QString getItemName(ItemType item);
+/**
+ * @brief Stock à plat : un compteur par type d'item, indexé par itemIndex, sans recherche dans une map.
+ */
+using FlatStock = std::array<int, NB_ITEM_TYPES>;
 
-enum class EmployeeType {Supplier, Nurse, Doctor};
+class Seller;
 
-EmployeeType getEmployeeThatProduces(ItemType item);
-int getEmployeeSalary(EmployeeType employee);
+/**
+ * @brief Vue non possédante sur une liste de vendeurs : une ligne de LinkTable, ou un vecteur qui survit à la vue.
+ */
+class SellerList {
+public:
+    SellerList() = default;
+    SellerList(Seller* const* first, std::size_t count) : first(first), count(count) {}
+    SellerList(const std::vector<Seller*>& sellers) : first(sellers.data()), count(sellers.size()) {}
+    SellerList(std::vector<Seller*>&&) = delete; // La vue ne doit pas survivre au vecteur
+
+    Seller* const* begin() const { return first; }
+    Seller* const* end() const { return first + count; }
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    Seller* operator[](std::size_t i) const { return first[i]; }
+
+private:
+    Seller* const* first = nullptr;
+    std::size_t count = 0;
+};
 
 class Seller {
 public:
     /**
      * @brief Seller
      * @param money money money !
+     * @param windowInterface Interface de la simulation à laquelle appartient le vendeur (logs et mises à jour)
      */
-    Seller(int money, int uniqueId) : money(money), uniqueId(uniqueId) {}
+    Seller(int money, int uniqueId, IWindowInterface* windowInterface)
+        : uniqueId(uniqueId), interface(windowInterface), money(money), rng(std::random_device{}()) {}
+
+    virtual ~Seller() = default;
 
     /**
      * @brief getItemsForSale
@@ -46,9 +85,10 @@ public:
     /**
      * @brief chooseRandomSeller
      * @param sellers
+     * @param rng Random engine of the calling seller (seeded through Replay, so draws can be replayed)
      * @return Returns a random seller from the sellers vector
      */
-    static Seller* chooseRandomSeller(std::vector<Seller*>& sellers);
+    static Seller* chooseRandomSeller(SellerList sellers, std::mt19937& rng);
 
     /**
      * @brief getRandomItemFromStock
@@ -60,7 +100,7 @@ public:
         }
 
         auto it = stocks.begin();
-        std::advance(it, rand() % stocks.size());
+        std::advance(it, rng() % stocks.size());
 
         return it->first;
     }
@@ -76,13 +116,160 @@ public:
 
     int getUniqueId() { return uniqueId; }
 
+    /**
+     * @brief carries
+     * Indique, sans verrou, si le vendeur vend ce type d'item : un acheteur peut éviter de prendre
+     * le mutex d'un vendeur qui ne l'a de toute façon pas.
+     */
+    bool carries(ItemType item) const { return carried.contains(item); }
+
+    /**
+     * @brief setPlacementGroup
+     * @param group Groupe de cœurs sur lequel le thread du vendeur est épinglé (cf. ActorPlacement), -1 sans placement
+     */
+    void setPlacementGroup(int group) { placementGroup = group; }
+
+    /**
+     * @brief setPatientTracker
+     * Suit les patients de ce vendeur dans le tracker de sa simulation. À appeler avant le lancement des threads ;
+     * sans tracker (par défaut), aucune fiche n'est tenue.
+     */
+    virtual void setPatientTracker(PatientTracker* patientTracker) { tracker = patientTracker; }
+
+    /**
+     * @brief setReplay
+     * Place les itérations du vendeur dans l'enregistrement ou le rejeu de sa simulation, et tire son générateur
+     * aléatoire de la graine enregistrée ou rejouée. À appeler avant le lancement des threads.
+     */
+    void setReplay(Replay* simulationReplay) {
+        replay = simulationReplay;
+        rng.seed(replay->seedFor(uniqueId));
+    }
+
+    /**
+     * @brief getCrossGroupCalls
+     * @return Le nombre d'appels à send/request reçus d'un acteur épinglé sur un autre groupe de cœurs
+     */
+    int getCrossGroupCalls() const { return crossGroupCalls.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief enableInbox
+     * Le vendeur traitera les ordres de sa boîte aux lettres dans sa routine : les acheteurs lui déposent
+     * leurs ordres (cf. trade) au lieu d'appeler send/request depuis leur thread. À appeler avant le lancement des threads.
+     */
+    void enableInbox() { inboxEnabled = true; }
+    bool hasInbox() const { return inboxEnabled; }
+
+    /**
+     * @brief post
+     * Dépose un ordre dans la boîte aux lettres, sans verrou. L'ordre doit survivre jusqu'à la réponse.
+     * @return La réponse à venir : le montant de la transaction, 0 si refusée ou si le vendeur est arrêté
+     */
+    std::future<int> post(Order& order);
+
 protected:
+    /**
+     * @brief trade
+     * Transaction avec un autre vendeur : appel direct, ou ordre déposé dans sa boîte aux lettres s'il en a une.
+     * En attendant la réponse, le vendeur traite sa propre boîte aux lettres. Les fiches des patients suivent
+     * l'ordre, le coursier du thread courant se comporte comme pour un appel direct.
+     * @return Le montant de la transaction, 0 si refusée
+     */
+    int trade(Seller* seller, OrderKind kind, ItemType item, int qty, int bill = 0);
+
+    /**
+     * @brief awaitReply
+     * Attend la réponse d'un ordre en traitant les ordres reçus entre-temps : deux vendeurs qui s'attendent
+     * l'un l'autre progressent toujours. Le vendeur dort sur sa sonnette, sonnée par la réponse (cf. Order::replyBell)
+     * ou par un nouvel ordre.
+     */
+    int awaitReply(std::future<int>& reply);
+
+    /**
+     * @brief serveOrders
+     * Traite les ordres reçus (send/request appelés dans le thread du vendeur). Ne doit pas être appelée
+     * avec le mutex du vendeur verrouillé.
+     */
+    void serveOrders();
+
+    /**
+     * @brief workServingOrders
+     * Attente simulée de la routine du vendeur. Avec une boîte aux lettres, le vendeur dort sur sa sonnette
+     * jusqu'à la fin de l'attente et traite chaque ordre dès son dépôt ; sinon, comme interface->simulateWork().
+     */
+    void workServingOrders();
+
+    /**
+     * @brief reply
+     * Répond à un ordre et réveille l'appelant qui attend sur sa sonnette.
+     */
+    static void reply(Order* order, int amount);
+
+    /**
+     * @brief closeInbox
+     * À la fin de la routine : refuse les ordres en attente et ceux qui arriveront ensuite.
+     */
+    void closeInbox();
+
+    /**
+     * @brief noteCall
+     * À appeler à l'entrée de send/request : compte les appels venant d'un autre groupe de cœurs,
+     * dont le mutex et les stocks du vendeur font alors le trajet entre caches.
+     */
+    void noteCall() {
+        int callerGroup = ActorPlacement::currentGroup();
+        if (placementGroup >= 0 && callerGroup >= 0 && callerGroup != placementGroup) {
+            crossGroupCalls.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Configuration du vendeur : écrite à la construction, ensuite seulement lue par tous les threads
+    int uniqueId;
+
+    // Interface propre à la simulation du vendeur : plusieurs simulations peuvent coexister dans un processus
+    IWindowInterface* interface;
+
+    int placementGroup = -1;
+
+    // Suivi des patients de la simulation, nul s'il est désactivé
+    PatientTracker* tracker = nullptr;
+
+    // Enregistrement ou rejeu de la simulation, nul sans l'un ni l'autre
+    Replay* replay = nullptr;
+
+    // Types d'items vendus par request(), fixés par la sous-classe à la construction
+    ItemSet carried;
+
+    bool inboxEnabled = false;
+
+    // État mutable, protégé par le mutex de la sous-classe. Il commence sur sa propre ligne de cache :
+    // les écritures des acheteurs n'invalident ni la configuration ci-dessus, ni l'objet voisin en mémoire
+    // (l'alignement du membre rend tout le vendeur aligné, et sa taille multiple d'une ligne)
+    alignas(CACHE_LINE_SIZE) int money;
+
     /**
      * @brief stocks : Type, Quantité
      */
     std::map<ItemType, int> stocks;
-    int money;
-    int uniqueId;
+
+    // Fiches individuelles des patients présents (suivi optionnel, cf. PatientTracker),
+    // protégées par le même mutex que stocks
+    PatientQueue sickRecords;
+    PatientQueue healedRecords;
+
+    // Générateur aléatoire propre au vendeur, dont la graine est enregistrée/rejouée par Replay (cf. setReplay).
+    // Utilisé seulement par le thread du vendeur
+    alignas(CACHE_LINE_SIZE) std::mt19937 rng;
+
+    // Incrémenté sans verrou par les appelants d'autres groupes de cœurs
+    alignas(CACHE_LINE_SIZE) std::atomic<int> crossGroupCalls{0};
+
+    // Boîte aux lettres : déposée par les acheteurs, lue par le seul thread du vendeur
+    MpscQueue<Order> inbox;
+    alignas(CACHE_LINE_SIZE) std::atomic<int> posting{0};   // Dépôts en cours, attendus par closeInbox
+    std::atomic<bool> inboxClosed{false};
+    // Sonnée après chaque ordre déposé et chaque réponse à un ordre du vendeur : il y dort au lieu de scruter
+    ShmDoorbell inboxBell{};
 };
 
 #endif // SELLER_H
@@ -0,0 +1,379 @@
+#include "shard.h"
+
+#include <QDebug>
+#include <thread>
+
+// Acteur dont le thread courant exécute la routine, pour choisir son canal lors d'un appel distant
+static thread_local int currentCaller = -1;
+
+static std::size_t alignUp(std::size_t size) {
+    return (size + 63) & ~std::size_t(63);
+}
+
+static std::size_t channelBytes() {
+    return 2 * ShardRing::bytes() + alignUp(sizeof(ShmDoorbell));
+}
+
+RemoteSeller::RemoteSeller(int uniqueId, int ownerShard, Shard& shard, IWindowInterface* windowInterface)
+    : Seller(0, uniqueId, windowInterface), ownerShard(ownerShard), shard(shard)
+{
+    // Le vendeur réel est dans une autre partition : c'est lui qui refusera les items qu'il n'a pas
+    carried = ItemRegistry::all();
+}
+
+std::map<ItemType, int> RemoteSeller::getItemsForSale() {
+    ShardMessage msg{};
+    msg.op = ShardMessage::GetItemsForSale;
+    msg.target = uniqueId;
+
+    ShardMessage reply = shard.call(ownerShard, msg);
+    std::map<ItemType, int> items;
+    for (int i = 0; i < static_cast<int>(reply.stock.size()); ++i) {
+        if (reply.stock[i]) {
+            items[static_cast<ItemType>(i)] = reply.stock[i];
+        }
+    }
+    return items;
+}
+
+int RemoteSeller::send(ItemType it, int qty, int bill) {
+    ShardMessage msg{};
+    msg.op = ShardMessage::Send;
+    msg.target = uniqueId;
+    msg.item = static_cast<std::int32_t>(it);
+    msg.qty = qty;
+    msg.bill = bill;
+    return shard.call(ownerShard, msg).result;
+}
+
+int RemoteSeller::request(ItemType what, int qty) {
+    ShardMessage msg{};
+    msg.op = ShardMessage::Request;
+    msg.target = uniqueId;
+    msg.item = static_cast<std::int32_t>(what);
+    msg.qty = qty;
+    return shard.call(ownerShard, msg).result;
+}
+
+static int nbActorsOf(const SimulationConfig& config) {
+    return config.nbSuppliers + config.nbHospitals + config.nbClinics;
+}
+
+std::size_t Shard::sharedMemorySize(const SimulationConfig& config, int nbShards) {
+    return alignUp(sizeof(ShardControl)) + std::size_t(nbActorsOf(config)) * nbShards * channelBytes();
+}
+
+int Shard::shardOf(const SimulationConfig& config, int nbShards, int actorId) {
+    if (actorId < config.nbSuppliers) {
+        return actorId % nbShards;
+    }
+
+    int hospital = actorId - config.nbSuppliers;
+    if (hospital < config.nbHospitals) {
+        return hospital % nbShards;
+    }
+
+    // Mêmes groupes que Utils : chaque hôpital a son bloc de cliniques, le reste est partagé
+    int clinic = hospital - config.nbHospitals;
+    int clinicsByHospital = config.nbClinics / config.nbHospitals;
+    if (clinicsByHospital && clinic < clinicsByHospital * config.nbHospitals) {
+        return (clinic / clinicsByHospital) % nbShards;
+    }
+    return clinic % nbShards;
+}
+
+Shard::Shard(const SimulationConfig& config, int shardIndex, int nbShards, void* sharedMemory, IWindowInterface* windowInterface)
+    : config(config), shardIndex(shardIndex), nbShards(nbShards), nbActors(nbActorsOf(config)),
+      control(static_cast<ShardControl*>(sharedMemory)),
+      channels(static_cast<char*>(sharedMemory) + alignUp(sizeof(ShardControl))),
+      interface(windowInterface), sellers(nbActors, nullptr), local(nbActors, false), abandoned(false), remoteCalls(0)
+{
+    ItemRegistry::freeze();
+
+    const int nbSupplier = config.nbSuppliers;
+    const int nbHospital = config.nbHospitals;
+    const int nbClinic = config.nbClinics;
+
+    for (int id = 0; id < nbActors; ++id) {
+        local[id] = shardOf(config, nbShards, id) == shardIndex;
+
+        bool caller = !(id < config.nbSuppliers && id % 3 != 0); // Les fournisseurs n'appellent personne
+        if (!local[id] && caller) {
+            callers.push_back(id);
+        }
+    }
+
+    auto remote = [&](int id) -> Seller* {
+        return arena.create<RemoteSeller>(id, shardOf(config, nbShards, id), *this, windowInterface);
+    };
+
+    // Même numérotation que Utils : ambulances et fournisseurs, puis hôpitaux, puis cliniques
+    std::vector<Seller*> allSuppliers;
+    for (int i = 0; i < nbSupplier; ++i) {
+        if (!local[i]) {
+            sellers[i] = remote(i);
+        } else if (i % 3 == 0) {
+            std::map<ItemType, int> initialAmbulanceStock = {{ItemType::PatientSick, config.initialPatientsSick}};
+            ambulances.push_back(arena.create<Ambulance>(i, config.supplierFund, std::vector<ItemType>{ItemType::PatientSick},
+                                                         initialAmbulanceStock, windowInterface));
+            sellers[i] = ambulances.back();
+        } else {
+            suppliers.push_back(i % 3 == 1 ? static_cast<Supplier*>(arena.create<MedicalDeviceSupplier>(i, config.supplierFund, windowInterface, config.producersPerSupplier))
+                                           : static_cast<Supplier*>(arena.create<Pharmacy>(i, config.supplierFund, windowInterface, config.producersPerSupplier)));
+            sellers[i] = suppliers.back();
+        }
+        if (i % 3 != 0) {
+            allSuppliers.push_back(sellers[i]);
+        }
+    }
+
+    std::vector<Seller*> allHospitals;
+    for (int h = 0; h < nbHospital; ++h) {
+        int id = nbSupplier + h;
+        if (local[id]) {
+            hospitals.push_back(arena.create<Hospital>(id, config.hospitalFund, config.bedsPerHospital, windowInterface));
+            sellers[id] = hospitals.back();
+        } else {
+            sellers[id] = remote(id);
+        }
+        allHospitals.push_back(sellers[id]);
+    }
+
+    std::vector<Seller*> allClinics;
+    for (int c = 0; c < nbClinic; ++c) {
+        int id = nbSupplier + nbHospital + c;
+        if (local[id]) {
+            switch (c % 3) {
+            case 0:
+                clinics.push_back(arena.create<Pulmonology>(id, config.clinicFund, windowInterface, config.doctorsPerClinic));
+                break;
+            case 1:
+                clinics.push_back(arena.create<Cardiology>(id, config.clinicFund, windowInterface, config.doctorsPerClinic));
+                break;
+            case 2:
+                clinics.push_back(arena.create<Neurology>(id, config.clinicFund, windowInterface, config.doctorsPerClinic));
+                break;
+            }
+            sellers[id] = clinics.back();
+        } else {
+            sellers[id] = remote(id);
+        }
+        allClinics.push_back(sellers[id]);
+    }
+
+    // Les vues distribuées aux acteurs pointent dans la table des liens : toutes les lignes d'abord
+    int clinicsByHospital = nbClinic / nbHospital;
+    int clinicsShared = nbClinic % nbHospital;
+    int hospitalsRow = links.addRow(allHospitals);
+    int suppliersRow = links.addRow(allSuppliers);
+    std::vector<int> clinicsRows;
+    for (Hospital* hospital : hospitals) {
+        int h = hospital->getUniqueId() - nbSupplier;
+        std::vector<Seller*> hospitalClinics(allClinics.begin() + h * clinicsByHospital,
+                                             allClinics.begin() + (h + 1) * clinicsByHospital);
+        hospitalClinics.insert(hospitalClinics.end(), allClinics.end() - clinicsShared, allClinics.end());
+        clinicsRows.push_back(links.addRow(hospitalClinics));
+    }
+
+    for (size_t h = 0; h < hospitals.size(); ++h) {
+        hospitals[h]->setClinics(links.row(clinicsRows[h]));
+    }
+    for (Ambulance* ambulance : ambulances) {
+        ambulance->setHospitals(links.row(hospitalsRow));
+    }
+    for (Clinic* clinic : clinics) {
+        clinic->setHospitalsAndSuppliers(links.row(hospitalsRow), links.row(suppliersRow));
+    }
+}
+
+Shard::~Shard() {
+    ItemRegistry::thaw();
+}
+
+char* Shard::channel(int callerId, int targetShard) const {
+    return channels + (std::size_t(callerId) * nbShards + targetShard) * channelBytes();
+}
+
+ShardRing Shard::requests(int callerId, int targetShard) const {
+    return ShardRing(channel(callerId, targetShard));
+}
+
+ShardRing Shard::responses(int callerId, int targetShard) const {
+    return ShardRing(channel(callerId, targetShard) + ShardRing::bytes());
+}
+
+ShmDoorbell& Shard::replied(int callerId, int targetShard) const {
+    return *reinterpret_cast<ShmDoorbell*>(channel(callerId, targetShard) + 2 * ShardRing::bytes());
+}
+
+ShardMessage Shard::call(int targetShard, const ShardMessage& msg) {
+    if (currentCaller < 0) {
+        qCritical() << "Remote call from a thread that is not an actor of shard" << shardIndex;
+        return ShardMessage{};
+    }
+    remoteCalls.fetch_add(1, std::memory_order_relaxed);
+
+    ShardRing out = requests(currentCaller, targetShard);
+    ShardRing in = responses(currentCaller, targetShard);
+    ShmDoorbell& bell = replied(currentCaller, targetShard);
+
+    // Un seul appel en cours par canal : la file des requêtes a toujours de la place
+    while (!out.tryPush(msg)) {
+        std::this_thread::yield();
+    }
+    control->incoming[targetShard].ring();
+
+    // Quelques passages de tour pour les réponses rapides, puis sommeil jusqu'à la sonnerie du serveur
+    ShardMessage reply;
+    for (int round = 0;; ++round) {
+        std::uint32_t seen = bell.sequence();
+        if (in.tryPop(reply)) {
+            return reply;
+        }
+        if (round < SHARD_SPIN_ROUNDS) {
+            std::this_thread::yield();
+        } else {
+            bell.wait(seen, SHARD_IDLE_WAIT_US);
+        }
+    }
+}
+
+ShardMessage Shard::handle(const ShardMessage& msg) {
+    ShardMessage reply = msg;
+    Seller* seller = sellers[msg.target];
+
+    switch (msg.op) {
+    case ShardMessage::Send:
+        reply.result = seller->send(static_cast<ItemType>(msg.item), msg.qty, msg.bill);
+        break;
+    case ShardMessage::Request:
+        reply.result = seller->request(static_cast<ItemType>(msg.item), msg.qty);
+        break;
+    case ShardMessage::GetItemsForSale:
+        reply.stock.fill(0);
+        for (const auto& item : seller->getItemsForSale()) {
+            // Taille fixe du message : les items du registre, numérotés après le catalogue, ne passent pas
+            if (item.first != ItemType::Nothing && isCatalogItem(item.first)) {
+                reply.stock[static_cast<int>(item.first)] = item.second;
+            }
+        }
+        break;
+    }
+    return reply;
+}
+
+void Shard::serve() {
+    ShmDoorbell& doorbell = control->incoming[shardIndex];
+
+    for (;;) {
+        // Lue avant de parcourir les canaux : une requête déposée pendant le parcours fait échouer le sommeil
+        std::uint32_t seen = doorbell.sequence();
+
+        bool served = false;
+        for (int callerId : callers) {
+            ShardMessage msg;
+            if (requests(callerId, shardIndex).tryPop(msg)) {
+                ShardMessage reply = handle(msg);
+                ShardRing out = responses(callerId, shardIndex);
+                while (!out.tryPush(reply)) {
+                    std::this_thread::yield();
+                }
+                replied(callerId, shardIndex).ring();
+                served = true;
+            }
+        }
+        if (served) {
+            continue;
+        }
+
+        // Les appels sont synchrones : quand toutes les partitions ont arrêté leurs acteurs, plus rien n'arrive
+        if (control->actorsDone.load(std::memory_order_acquire) == nbShards || abandoned.load()) {
+            return;
+        }
+        doorbell.wait(seen, SHARD_IDLE_WAIT_US);
+    }
+}
+
+bool Shard::run() {
+    // Un seul serveur pour tous les canaux entrants, endormi tant qu'aucune requête n'arrive
+    std::unique_ptr<PcoThread> server;
+    if (!callers.empty()) {
+        server = std::make_unique<PcoThread>(&Shard::serve, this);
+    }
+
+    control->ready.fetch_add(1, std::memory_order_acq_rel);
+    while (control->ready.load(std::memory_order_acquire) < nbShards) {
+        // Une partition n'a pas pu démarrer : le coordinateur demande l'arrêt sans qu'elle ne soit jamais prête
+        if (control->stop.load(std::memory_order_acquire)) {
+            abandoned = true;
+            control->incoming[shardIndex].ring();
+            if (server) {
+                server->join();
+            }
+            return false;
+        }
+        PcoThread::usleep(100);
+    }
+
+    std::vector<std::unique_ptr<PcoThread>> threads;
+    auto start = [&](Seller* actor, auto routine) {
+        threads.emplace_back(std::make_unique<PcoThread>([actor, routine]() {
+            currentCaller = actor->getUniqueId();
+            routine();
+        }));
+    };
+    for (Ambulance* a : ambulances) {
+        start(a, [a]() { a->run(); });
+    }
+    for (Supplier* s : suppliers) {
+        start(s, [s]() { s->run(); });
+    }
+    for (Clinic* c : clinics) {
+        start(c, [c]() { c->run(); });
+    }
+    for (Hospital* h : hospitals) {
+        start(h, [h]() { h->run(); });
+    }
+
+    while (!control->stop.load(std::memory_order_acquire)) {
+        PcoThread::usleep(1000);
+    }
+    for (auto& thread : threads) {
+        thread->requestStop();
+    }
+    for (auto& thread : threads) {
+        thread->join();
+    }
+
+    // La dernière partition arrêtée réveille tous les serveurs : ils constatent la fin et s'arrêtent
+    if (control->actorsDone.fetch_add(1, std::memory_order_acq_rel) + 1 == nbShards) {
+        for (int k = 0; k < nbShards; ++k) {
+            control->incoming[k].ring();
+        }
+    }
+    if (server) {
+        server->join();
+    }
+
+    ShardResult result{};
+    for (Ambulance* ambulance : ambulances) {
+        result.fund += ambulance->getFund() + ambulance->getAmountPaidToWorkers();
+        result.patients += ambulance->getNumberPatients();
+        result.rejectedAdmissions += ambulance->getRejectedAdmissions();
+    }
+    for (Supplier* supplier : suppliers) {
+        result.fund += supplier->getFund() + supplier->getAmountPaidToWorkers();
+    }
+    for (Clinic* clinic : clinics) {
+        result.fund += clinic->getFund() + clinic->getAmountPaidToWorkers();
+        result.patients += clinic->getNumberPatients();
+    }
+    for (Hospital* hospital : hospitals) {
+        result.fund += hospital->getFund() + hospital->getAmountPaidToWorkers();
+        result.patients += hospital->getNumberPatients();
+        result.discharged += hospital->getDischargedPatients();
+    }
+    result.remoteCalls = remoteCalls.load();
+    control->results[shardIndex] = result;
+    return true;
+}
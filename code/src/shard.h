@@ -0,0 +1,164 @@
+#ifndef SHARD_H
+#define SHARD_H
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <pcosynchro/pcothread.h>
+
+#include "iwindowinterface.h"
+#include "shmring.h"
+#include "utils.h"
+
+#define SHARD_MAX 16             // Nombre maximum de partitions
+#define SHARD_RING_CAPACITY 4    // Un appel synchrone à la fois par canal : quelques cases suffisent
+#define SHARD_SPIN_ROUNDS 64     // Passages de tour d'un appelant avant de s'endormir sur la sonnette de sa réponse
+#define SHARD_IDLE_WAIT_US 10000 // Sommeil maximal sur une sonnette, filet de sécurité (toute sonnerie réveille avant)
+
+/**
+ * @brief Message échangé entre deux partitions : appel d'un Seller distant et sa réponse.
+ *        Pour GetItemsForSale, la réponse porte le stock des items du catalogue (indexé par ItemType) ;
+ *        les items chargés à l'exécution (ItemRegistry) n'y figurent pas.
+ */
+struct ShardMessage {
+    enum Op : std::int32_t { Send, Request, GetItemsForSale };
+
+    std::int32_t op;
+    std::int32_t target;   // uniqueId du vendeur appelé
+    std::int32_t item;
+    std::int32_t qty;
+    std::int32_t bill;
+    std::int32_t result;
+    std::array<std::int32_t, static_cast<int>(ItemType::Nothing)> stock;
+};
+
+using ShardRing = ShmRing<ShardMessage, SHARD_RING_CAPACITY>;
+
+/**
+ * @brief Bilan d'une partition, écrit dans la mémoire partagée à la fin de Shard::run.
+ */
+struct ShardResult {
+    int fund;             // Fonds + salaires versés, pour les acteurs locaux
+    int patients;
+    int discharged;
+    int rejectedAdmissions;
+    long remoteCalls;     // Appels envoyés aux autres partitions
+};
+
+/**
+ * @brief En-tête de la mémoire partagée, suivi des canaux (cf. Shard::sharedMemorySize).
+ */
+struct ShardControl {
+    std::atomic<int> ready;        // Partitions prêtes à servir les appels distants
+    std::atomic<int> actorsDone;   // Partitions dont tous les acteurs sont arrêtés
+    std::atomic<bool> stop;        // Demande d'arrêt, posée par le coordinateur
+    ShardResult results[SHARD_MAX];
+    ShmDoorbell incoming[SHARD_MAX]; // Sonnée par un appelant après chaque requête déposée pour la partition
+
+};
+
+class Shard;
+
+/**
+ * @brief Représentant local d'un vendeur d'une autre partition.
+ *        send/request/getItemsForSale sont transmis au processus propriétaire et attendent sa réponse,
+ *        si bien que l'appelant voit la même sémantique qu'un appel direct.
+ */
+class RemoteSeller : public Seller {
+public:
+    RemoteSeller(int uniqueId, int ownerShard, Shard& shard, IWindowInterface* windowInterface);
+
+    std::map<ItemType, int> getItemsForSale() override;
+    int send(ItemType it, int qty, int bill) override;
+    int request(ItemType what, int qty) override;
+
+private:
+    int ownerShard;
+    Shard& shard;
+};
+
+/**
+ * @brief Une partition de la simulation, exécutée dans son propre processus.
+ *        Le réseau est le même que celui de Utils ; chaque hôpital est placé avec ses cliniques,
+ *        les fournisseurs et ambulances sont répartis à tour de rôle. Les vendeurs des autres partitions
+ *        sont remplacés par des RemoteSeller.
+ *
+ *        Chaque acteur appelant (ambulance, clinique, hôpital) dispose, vers chaque autre partition, d'un canal
+ *        formé de deux files SPSC (requêtes, réponses) et d'une sonnette de réponse en mémoire partagée.
+ *        Un seul thread par partition sert tous ses canaux entrants et exécute les appels comme l'aurait fait
+ *        l'appelant : les verrous pris sont les mêmes qu'en mémoire commune, et aucun appel servi ne prend un verrou
+ *        gardé pendant un appel distant. Serveur et appelants dorment sur leurs sonnettes (futex) au lieu de sonder.
+ *        Les appels étant synchrones, rien n'est en transit une fois tous les acteurs arrêtés, et les bilans des
+ *        partitions s'additionnent exactement.
+ */
+class Shard {
+public:
+    /**
+     * @brief Shard
+     * @param sharedMemory Mémoire partagée initialisée à zéro, d'au moins sharedMemorySize() octets
+     */
+    Shard(const SimulationConfig& config, int shardIndex, int nbShards, void* sharedMemory, IWindowInterface* windowInterface);
+
+    /**
+     * @brief ~Shard
+     * Dégèle le registre des items, gelé pendant la vie de la partition comme pour Utils.
+     */
+    ~Shard();
+
+    static std::size_t sharedMemorySize(const SimulationConfig& config, int nbShards);
+    static int shardOf(const SimulationConfig& config, int nbShards, int actorId);
+
+    /**
+     * @brief run
+     * Attend que toutes les partitions soient prêtes, fait tourner les acteurs locaux jusqu'à la demande d'arrêt
+     * (ShardControl::stop), continue de servir les autres partitions jusqu'à ce que toutes aient arrêté leurs
+     * acteurs, puis publie le bilan dans ShardControl::results.
+     * @return false si l'arrêt est demandé avant que toutes les partitions soient prêtes (une partition n'a pas
+     *         pu démarrer) : aucun acteur n'a tourné et aucun bilan n'est publié
+     */
+    bool run();
+
+    /**
+     * @brief call
+     * Envoie un appel à la partition propriétaire de msg.target, depuis le canal de l'acteur du thread courant.
+     */
+    ShardMessage call(int targetShard, const ShardMessage& msg);
+
+private:
+    char* channel(int callerId, int targetShard) const;
+    ShardRing requests(int callerId, int targetShard) const;
+    ShardRing responses(int callerId, int targetShard) const;
+    ShmDoorbell& replied(int callerId, int targetShard) const;
+    ShardMessage handle(const ShardMessage& msg);
+
+    /**
+     * @brief serve
+     * Sert les canaux de tous les appelants distants jusqu'à ce que toutes les partitions aient arrêté leurs acteurs.
+     */
+    void serve();
+
+    SimulationConfig config;
+    int shardIndex;
+    int nbShards;
+    int nbActors;
+    ShardControl* control;
+    char* channels;
+    IWindowInterface* interface;
+
+    SimulationArena arena;                 // Acteurs locaux et mandataires, libérés avec la partition
+    LinkTable links;
+
+    std::vector<Seller*> sellers;          // Indexé par uniqueId, local ou RemoteSeller
+    std::vector<bool> local;
+    std::vector<int> callers;              // Acteurs distants qui appellent cette partition (canaux servis)
+    std::vector<Ambulance*> ambulances;    // Acteurs locaux, pour les threads et le bilan
+    std::vector<Supplier*> suppliers;
+    std::vector<Clinic*> clinics;
+    std::vector<Hospital*> hospitals;
+
+    std::atomic<bool> abandoned;           // Démarrage abandonné : les serveurs s'arrêtent sans attendre les autres partitions
+    std::atomic<long> remoteCalls;
+};
+
+#endif // SHARD_H
@@ -0,0 +1,60 @@
+#include "shmring.h"
+
+#include <QDebug>
+#include <climits>
+#include <ctime>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// Futex partagé (sans FUTEX_PRIVATE_FLAG) : fonctionne entre processus sur une projection MAP_SHARED
+static long futex(std::atomic<std::uint32_t>* word, int op, std::uint32_t value, const timespec* timeout) {
+    return syscall(SYS_futex, reinterpret_cast<std::uint32_t*>(word), op, value, timeout, nullptr, 0);
+}
+
+void ShmDoorbell::ring() {
+    rings.fetch_add(1, std::memory_order_seq_cst);
+    if (sleepers.load(std::memory_order_seq_cst)) {
+        futex(&rings, FUTEX_WAKE, INT_MAX, nullptr);
+    }
+}
+
+void ShmDoorbell::wait(std::uint32_t seen, unsigned timeoutUs) {
+    sleepers.fetch_add(1, std::memory_order_seq_cst);
+    if (rings.load(std::memory_order_seq_cst) == seen) {
+        timespec timeout{time_t(timeoutUs / 1000000), long(timeoutUs % 1000000) * 1000};
+        futex(&rings, FUTEX_WAIT, seen, &timeout);
+    }
+    sleepers.fetch_sub(1, std::memory_order_seq_cst);
+}
+
+ShmSegment::ShmSegment(const std::string& name, std::size_t size) : name(name), length(size), memory(nullptr) {
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0) {
+        qCritical() << "Could not create shared memory segment" << name.c_str();
+        return;
+    }
+
+    // ftruncate remplit le segment de zéros : toutes les files sont vides
+    if (ftruncate(fd, size) == 0) {
+        void* mapped = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        if (mapped != MAP_FAILED) {
+            memory = mapped;
+        }
+    }
+    close(fd);
+
+    if (!memory) {
+        qCritical() << "Could not map shared memory segment" << name.c_str();
+        shm_unlink(name.c_str());
+    }
+}
+
+ShmSegment::~ShmSegment() {
+    if (memory) {
+        munmap(memory, length);
+        shm_unlink(name.c_str());
+    }
+}
@@ -0,0 +1,113 @@
+#ifndef SHMRING_H
+#define SHMRING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+/**
+ * @brief Segment de mémoire partagée POSIX (shm_open + mmap).
+ *        Le segment est créé et mis à zéro par le constructeur ; il reste projeté dans les processus
+ *        créés ensuite par fork(). Le créateur le supprime (shm_unlink) à la destruction.
+ */
+class ShmSegment {
+public:
+    ShmSegment(const std::string& name, std::size_t size);
+    ~ShmSegment();
+
+    ShmSegment(const ShmSegment&) = delete;
+    ShmSegment& operator=(const ShmSegment&) = delete;
+
+    bool isValid() const { return memory != nullptr; }
+    void* data() const { return memory; }
+    std::size_t size() const { return length; }
+
+private:
+    std::string name;
+    std::size_t length;
+    void* memory;
+};
+
+/**
+ * @brief Sonnette en mémoire partagée : un compteur de sonneries sur lequel un thread s'endort (futex Linux)
+ *        jusqu'à ce qu'un autre thread ou processus sonne. Une mémoire mise à zéro est une sonnette valide.
+ *        Pour ne manquer aucune sonnerie : lire sequence(), vérifier la condition attendue, puis wait(seen).
+ */
+class ShmDoorbell {
+public:
+    std::uint32_t sequence() const { return rings.load(std::memory_order_acquire); }
+
+    /**
+     * @brief ring
+     * Sonne et réveille les threads endormis sur la sonnette ; sans dormeur, aucun appel système.
+     */
+    void ring();
+
+    /**
+     * @brief wait
+     * Dort tant que la sonnette n'a pas sonné depuis la lecture seen de sequence(), au plus timeoutUs µs.
+     */
+    void wait(std::uint32_t seen, unsigned timeoutUs);
+
+private:
+    std::atomic<std::uint32_t> rings;
+    std::atomic<std::uint32_t> sleepers;
+};
+
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free && sizeof(std::atomic<std::uint32_t>) == sizeof(std::uint32_t),
+              "Le compteur de la sonnette sert de mot futex");
+
+/**
+ * @brief File circulaire sans verrou, un seul producteur et un seul consommateur (SPSC),
+ *        placée dans une mémoire fournie (typiquement un ShmSegment partagé entre processus).
+ *        T doit être trivialement copiable, Capacity une puissance de 2.
+ *        La vue (ShmRing) ne possède rien : deux processus peuvent chacun en construire une sur la même mémoire.
+ */
+template<typename T, std::uint32_t Capacity>
+class ShmRing {
+    static_assert(std::is_trivially_copyable<T>::value, "Les messages sont copiés octet par octet");
+    static_assert(Capacity && (Capacity & (Capacity - 1)) == 0, "La capacité doit être une puissance de 2");
+    static_assert(std::atomic<std::uint32_t>::is_always_lock_free, "Les indices doivent être utilisables entre processus");
+
+    struct Layout {
+        alignas(64) std::atomic<std::uint32_t> head; // Prochaine case écrite (producteur)
+        alignas(64) std::atomic<std::uint32_t> tail; // Prochaine case lue (consommateur)
+        alignas(64) T slots[Capacity];
+    };
+
+public:
+    static constexpr std::size_t bytes() { return sizeof(Layout); }
+
+    /**
+     * @brief ShmRing
+     * @param memory Zone d'au moins bytes() octets, alignée sur 64 octets et mise à zéro (file vide)
+     */
+    explicit ShmRing(void* memory) : ring(static_cast<Layout*>(memory)) {}
+
+    bool tryPush(const T& value) {
+        std::uint32_t head = ring->head.load(std::memory_order_relaxed);
+        if (head - ring->tail.load(std::memory_order_acquire) == Capacity) {
+            return false;
+        }
+        ring->slots[head % Capacity] = value;
+        ring->head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool tryPop(T& value) {
+        std::uint32_t tail = ring->tail.load(std::memory_order_relaxed);
+        if (tail == ring->head.load(std::memory_order_acquire)) {
+            return false;
+        }
+        value = ring->slots[tail % Capacity];
+        ring->tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+private:
+    Layout* ring;
+};
+
+#endif // SHMRING_H
@@ -1,16 +1,20 @@
 #include "supplier.h"
 #include "costs.h"
 #include <pcosynchro/pcothread.h>
+#include <algorithm>
+#include <memory>
 #include <stdexcept>
 
-IWindowInterface* Supplier::interface = nullptr;
-
-Supplier::Supplier(int uniqueId, int fund, std::vector<ItemType> resourcesSupplied)
-    : Seller(fund, uniqueId), resourcesSupplied(resourcesSupplied), nbSupplied(0) 
+Supplier::Supplier(int uniqueId, int fund, std::vector<ItemType> resourcesSupplied, IWindowInterface* windowInterface, int nbProducers)
+    : Seller(fund, uniqueId, windowInterface), resourcesSupplied(resourcesSupplied), nbProducers(std::max(nbProducers, 1)),
+      slots(std::make_unique<ProductionSlot[]>(resourcesSupplied.size())), nbSupplied(0), nbProduced(0)
 {
-    for (const auto& item : resourcesSupplied) {    
-        stocks[item] = 0;
+    for (std::size_t i = 0; i < resourcesSupplied.size(); ++i) {
+        slotOf[resourcesSupplied[i]] = static_cast<int>(i);
+        misses[resourcesSupplied[i]] = 0;
+        carried.insert(resourcesSupplied[i]);
     }
+    publishStocks();
 
     interface->consoleAppendText(uniqueId, QString("Supplier Created"));
     interface->updateFund(uniqueId, fund);
@@ -18,51 +22,248 @@ Supplier::Supplier(int uniqueId, int fund, std::vector<ItemType> resourcesSuppli
 
 
 int Supplier::request(ItemType it, int qty) {
+    noteCall();
+
+    // Item non fourni ici : refusé sans prendre le verrou
+    if (qty <= 0 || !carried.contains(it)) {
+        return 0;
+    }
+
+    // Les unités sont prises sans verrou : un producteur peut publier pendant ce temps
+    std::atomic<int>& units = slots[slotOf.get(it)].units;
+    int available = units.load(std::memory_order_acquire);
+    while (available >= qty && !units.compare_exchange_weak(available, available - qty, std::memory_order_acquire)) {}
+
     int price = 0;
 
     mutex.lock();
-    auto listItem = getItemsForSale();
-
-    // If enough quantity in stocks and if qty is strictly greater than 0
-    // we sell, else returns 0 at the end of function
-    if (qty > 0 && listItem.find(it) != listItem.end() && listItem[it] >= qty) {
+    if (available >= qty) {
         price = getCostPerUnit(it) * qty;
-        stocks[it] -= qty;
         money += price;
         nbSupplied += qty;
+    } else {
+        // Demande manquée : elle oriente la prochaine production
+        misses[it] += qty;
     }
     mutex.unlock();
 
     return price;
 }
 
+int Supplier::plannedStock(ItemType item) const {
+    const ProductionSlot& slot = slots[slotOf.get(item)];
+    return slot.units.load(std::memory_order_relaxed) + slot.inProduction.load(std::memory_order_relaxed);
+}
+
+ItemType Supplier::chooseItemToProduce() {
+    ItemType best = ItemType::Nothing;
+    int bestScore = 0;
+
+    for (ItemType item : resourcesSupplied) {
+        // Les lots en cours comptent déjà : deux producteurs ne complètent pas le même manque
+        int stock = plannedStock(item);
+        if (stock >= SUPPLIER_HIGH_WATERMARK) {
+            continue;
+        }
+
+        // Sous le seuil bas, on complète jusqu'au seuil haut ; au-dessus, seule la demande manquée compte.
+        // Un item du registre n'a souvent aucun acheteur : le compléter viderait la caisse pour rien
+        int score = misses.get(item);
+        if (stock < SUPPLIER_LOW_WATERMARK && isCatalogItem(item)) {
+            score += SUPPLIER_HIGH_WATERMARK - stock;
+        }
+
+        if (score > bestScore) {
+            best = item;
+            bestScore = score;
+        }
+    }
+    return best;
+}
+
+int Supplier::batchSizeFor(ItemType item) {
+    int salary = getEmployeeSalary(getEmployeeThatProduces(item));
+    int batch = std::min(SUPPLIER_BATCH_SIZE, SUPPLIER_HIGH_WATERMARK - plannedStock(item));
+    if (!isCatalogItem(item)) {
+        batch = std::min(batch, misses.get(item));
+    }
+    return std::min(batch, money / salary);
+}
+
+int Supplier::reserveBatch(ItemType& item) {
+    mutex.lock();
+    item = chooseItemToProduce();
+    int batch = item == ItemType::Nothing ? 0 : batchSizeFor(item);
+    if (batch <= 0) {
+        mutex.unlock();
+        return 0;
+    }
+
+    // Réservation : salaires payés et lot annoncé avant le travail
+    money -= batch * getEmployeeSalary(getEmployeeThatProduces(item));
+    slots[slotOf.get(item)].inProduction.fetch_add(batch, std::memory_order_relaxed);
+    if (isCatalogItem(item)) {
+        misses[item] /= 2;
+    } else {
+        misses[item] -= batch;
+    }
+    nbProduced += batch;
+    mutex.unlock();
+    return batch;
+}
+
+void Supplier::publishBatch(ItemType item, int batch) {
+    // Publication sans verrou, les unités avant l'annonce : le stock prévu n'est jamais sous-estimé
+    ProductionSlot& slot = slots[slotOf.get(item)];
+    slot.units.fetch_add(batch, std::memory_order_release);
+    slot.inProduction.fetch_sub(batch, std::memory_order_relaxed);
+}
+
+bool Supplier::produce() {
+    ItemType resourceSupplied;
+    int batch = reserveBatch(resourceSupplied);
+    if (!batch) {
+        return false;
+    }
+
+    /* Temps aléatoire borné qui simule l'attente du travail fini*/
+    interface->simulateWork();
+
+    publishBatch(resourceSupplied, batch);
+    return true;
+}
+
+void Supplier::producerRoutine() {
+    while (!PcoThread::thisThread()->stopRequested()) {
+        if (!produce()) {
+            // Stocks suffisants ou fonds insuffisants : on attend de nouvelles demandes
+            interface->simulateWork();
+        }
+    }
+}
+
 void Supplier::run() {
     interface->consoleAppendText(uniqueId, "[START] Supplier routine");
+
+    // Les producteurs fabriquent en parallèle, la routine publie l'état du fournisseur. Pendant un enregistrement
+    // ou un rejeu, la production reste dans la routine pour que l'ordre des transactions soit total
+    std::vector<std::unique_ptr<PcoThread>> producers;
+    if (!replay) {
+        for (int i = 0; i < nbProducers; ++i) {
+            producers.emplace_back(std::make_unique<PcoThread>(&Supplier::producerRoutine, this));
+        }
+    }
+
     while (!PcoThread::thisThread()->stopRequested()) {
-        ItemType resourceSupplied = getRandomItemFromStock();
-        int supplierCost = getEmployeeSalary(getEmployeeThatProduces(resourceSupplied));
+        serveOrders();
+
+        // Sans producteurs, le lot est réservé puis publié dans deux itérations distinctes :
+        // l'ordre des transactions reste total sans garder l'itération pendant le travail
+        ItemType item = ItemType::Nothing;
+        int batch = 0;
+        {
+            ReplayStep step(replay, uniqueId);
+            if (!step.proceed()) {
+                break;
+            }
+            if (producers.empty()) {
+                batch = reserveBatch(item);
+            }
+        }
+
+        workServingOrders();
+
+        if (batch) {
+            // Publié même si le rejeu s'interrompt : les salaires du lot sont déjà payés
+            ReplayStep step(replay, uniqueId);
+            publishBatch(item, batch);
+            if (!step.proceed()) {
+                break;
+            }
+        }
 
         mutex.lock();
-        if (money < supplierCost) {
-            continue;
+        publishStocks();
+        mutex.unlock();
+
+        interface->updateFund(uniqueId, money);
+        interface->updateStock(uniqueId, &stocks);
+    }
+
+    // Les lots en cours sont publiés avant l'arrêt
+    for (auto& producer : producers) {
+        producer->requestStop();
+    }
+    for (auto& producer : producers) {
+        producer->join();
+    }
+    closeInbox();
+    interface->consoleAppendText(uniqueId, "[STOP] Supplier routine");
+}
+
+#ifdef HAS_COROUTINE_ACTORS
+ActorTask Supplier::producerTask(ActorScheduler& scheduler, std::atomic<int>& active, const ActorEvent& stopped) {
+    while (!scheduler.stopRequested()) {
+        ItemType item;
+        int batch = reserveBatch(item);
+
+        // Sans lot à produire, on attend de nouvelles demandes ; sinon c'est le temps du travail
+        co_await scheduler.sleep(interface->workDuration());
+
+        if (batch) {
+            publishBatch(item, batch);
         }
+    }
+    active.fetch_sub(1);
+    scheduler.notify(stopped);
+}
 
-        /* Temps aléatoire borné qui simule l'attente du travail fini*/
-        interface->simulateWork();
+ActorTask Supplier::runTask(ActorScheduler& scheduler) {
+    interface->consoleAppendText(uniqueId, "[START] Supplier routine");
+
+    std::atomic<int> producers{nbProducers};
+    ActorEvent producerStopped;
+    for (int i = 0; i < nbProducers; ++i) {
+        scheduler.spawn(producerTask(scheduler, producers, producerStopped));
+    }
 
-        money -= supplierCost;
-        stocks.at(resourceSupplied) += 1;
+    while (!scheduler.stopRequested()) {
+        co_await scheduler.sleep(interface->workDuration());
+
+        mutex.lock();
+        publishStocks();
         mutex.unlock();
 
         interface->updateFund(uniqueId, money);
         interface->updateStock(uniqueId, &stocks);
     }
+
+    // Les lots en cours sont publiés avant l'arrêt ; le compteur et l'événement vivent dans cette trame
+    co_await scheduler.until(producerStopped, [&producers]() { return producers.load() == 0; });
     interface->consoleAppendText(uniqueId, "[STOP] Supplier routine");
 }
+#endif
+
+void Supplier::publishStocks() {
+    for (std::size_t i = 0; i < resourcesSupplied.size(); ++i) {
+        stocks[resourcesSupplied[i]] = slots[i].units.load(std::memory_order_relaxed);
+    }
+}
 
 
 std::map<ItemType, int> Supplier::getItemsForSale() {
-    return stocks;
+    mutex.lock();
+    publishStocks();
+    std::map<ItemType, int> itemsForSale = stocks;
+    mutex.unlock();
+    return itemsForSale;
+}
+
+std::vector<ItemType> Supplier::withRegistered(std::vector<ItemType> items, SupplierKind kind) {
+    for (ItemType item : ItemRegistry::suppliedBy(kind).items()) {
+        items.push_back(item);
+    }
+    return items;
 }
 
 int Supplier::getMaterialCost() {
@@ -74,11 +275,7 @@ int Supplier::getMaterialCost() {
 }
 
 int Supplier::getAmountPaidToWorkers() {
-    return nbSupplied * getEmployeeSalary(EmployeeType::Supplier);
-}
-
-void Supplier::setInterface(IWindowInterface *windowInterface) {
-    interface = windowInterface;
+    return nbProduced * getEmployeeSalary(EmployeeType::Supplier);
 }
 
 std::vector<ItemType> Supplier::getResourcesSupplied() const
@@ -91,6 +288,10 @@ int Supplier::getQuantitySupplied() const {
     return nbSupplied;
 }
 
+int Supplier::getQuantityProduced() const {
+    return nbProduced;
+}
+
 int Supplier::send(ItemType it, int qty, int bill){
     return 0;
 }
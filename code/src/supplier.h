@@ -1,12 +1,21 @@
 #ifndef SUPPLIER_H
 #define SUPPLIER_H
 #include <QTimer>
+#include <atomic>
+#include <memory>
 
 #include "iwindowinterface.h"
 
 #include "costs.h"
 #include "seller.h"
 
+// Seuils de réapprovisionnement : un item passé sous le seuil bas est produit
+// par lots jusqu'au seuil haut. Les demandes non satisfaites (misses) font aussi
+// produire un item tant qu'il est sous le seuil haut.
+#define SUPPLIER_LOW_WATERMARK 4
+#define SUPPLIER_HIGH_WATERMARK 16
+#define SUPPLIER_BATCH_SIZE 4
+
 class Supplier : public Seller {
 public:
     /**
@@ -14,8 +23,10 @@ public:
      * @param uniqueId : ID du fournisseur
      * @param fund : Argent initial
      * @param resourcesSupplied : Liste des ressources fournies par ce Supplier
+     * @param windowInterface : Interface propre à ce fournisseur
+     * @param nbProducers : Nombre de producteurs, donc de lots fabriqués en même temps
      */
-    Supplier(int uniqueId, int fund, std::vector<ItemType> resourcesSupplied);
+    Supplier(int uniqueId, int fund, std::vector<ItemType> resourcesSupplied, IWindowInterface* windowInterface, int nbProducers);
 
     /**
      * @brief Obtenir les items à vendre
@@ -46,6 +57,14 @@ public:
      */
     void run();
 
+#ifdef HAS_COROUTINE_ACTORS
+    /**
+     * @brief runTask
+     * La boucle de run écrite en coroutine ; les producteurs sont eux aussi des coroutines du même ordonnanceur.
+     */
+    ActorTask runTask(ActorScheduler& scheduler);
+#endif
+
     /**
      * @brief Obtenir le coût des matériaux
      * @return Le coût total des matériaux pour les items fournis
@@ -58,11 +77,6 @@ public:
      */
     int getAmountPaidToWorkers();
 
-    /**
-     * @brief Configurer l'interface graphique pour l'affichage des informations
-     * @param windowInterface : Pointeur vers l'interface graphique utilisée pour afficher les logs et mises à jour
-     */
-    static void setInterface(IWindowInterface* windowInterface);
 
     /**
      * @brief Obtenir la liste des ressources fournies par ce fournisseur
@@ -76,11 +90,101 @@ public:
      */
     int getQuantitySupplied() const;
 
+    /**
+     * @brief Obtenir la quantité d'items produits par ce fournisseur
+     * @return Le nombre d'items produits (et donc de salaires payés)
+     */
+    int getQuantityProduced() const;
+
 protected:
+    /**
+     * @brief Choisit l'item à produire selon la demande récente et les seuils de stock
+     * Les items du registre n'ont pas de stock de base : ils ne sont produits que sur demande manquée.
+     * Doit être appelée avec le mutex verrouillé.
+     * @return L'item le plus demandé parmi ceux à réapprovisionner, ItemType::Nothing si aucun
+     */
+    ItemType chooseItemToProduce();
+
+    /**
+     * @brief Calcule la taille du lot à produire pour un item
+     * Doit être appelée avec le mutex verrouillé.
+     * @param item : Item à produire
+     * @return Le nombre d'unités à produire, borné par le lot, le seuil haut et les fonds
+     *         (et par la demande manquée pour un item du registre)
+     */
+    int batchSizeFor(ItemType item);
+
+    /**
+     * @brief Produit un lot : l'item et les salaires sont réservés sous le verrou, le travail se fait hors verrou
+     * et les unités finies sont publiées par un incrément atomique. Les requêtes ne sont jamais bloquées
+     * pendant la production.
+     * @return false si aucun item n'est à produire (stocks suffisants ou fonds insuffisants)
+     */
+    bool produce();
+
+    /**
+     * @brief Réserve le prochain lot à produire (première moitié de produce)
+     * @param item : Item choisi, ItemType::Nothing si aucun
+     * @return La taille du lot, 0 si rien n'est à produire
+     */
+    int reserveBatch(ItemType& item);
+
+    /**
+     * @brief Publie un lot fini réservé par reserveBatch, sans verrou (seconde moitié de produce)
+     */
+    void publishBatch(ItemType item, int batch);
+
+    /**
+     * @brief Routine d'un producteur : produit des lots tant que l'arrêt n'est pas demandé
+     */
+    void producerRoutine();
+
+#ifdef HAS_COROUTINE_ACTORS
+    /**
+     * @brief producerRoutine en coroutine : le travail d'un lot est un co_await, pas une attente du thread
+     * @param active : Producteurs encore en vie, attendus par runTask avant de s'arrêter
+     * @param stopped : Signalé par chaque producteur qui s'arrête
+     */
+    ActorTask producerTask(ActorScheduler& scheduler, std::atomic<int>& active, const ActorEvent& stopped);
+#endif
+
+    /**
+     * @brief Recopie les unités en stock dans la map stocks. Doit être appelée avec le mutex verrouillé.
+     */
+    void publishStocks();
+
+    /**
+     * @brief Unités d'un item en stock ou en cours de production. Doit être appelée avec le mutex verrouillé.
+     */
+    int plannedStock(ItemType item) const;
+
+    /**
+     * @brief withRegistered
+     * @return Les items intégrés suivis des items du registre produits par ce type de fournisseur
+     */
+    static std::vector<ItemType> withRegistered(std::vector<ItemType> items, SupplierKind kind);
+
+    /**
+     * @brief Compteurs d'un item fourni, modifiés sans verrou par les producteurs et les acheteurs
+     */
+    struct ProductionSlot {
+        alignas(CACHE_LINE_SIZE) std::atomic<int> units{0};  // Unités en stock, qui font foi
+        std::atomic<int> inProduction{0};                    // Unités réservées par un producteur, pas encore publiées
+    };
+
     std::vector<ItemType> resourcesSupplied;  // Liste des items que ce fournisseur gère
+    SparseStock slotOf;                       // Indice du compteur de chaque item fourni dans slots
+    const int nbProducers;
+
+    // Un compteur par item fourni (creux : seuls les items fournis y figurent, quel que soit le nombre
+    // de types enregistrés). La map stocks n'en est qu'une copie, publiée pour l'affichage et les acheteurs
+    std::unique_ptr<ProductionSlot[]> slots;
+
+    // Verrou et compteurs modifiés par les acheteurs, sur leurs propres lignes de cache
+    alignas(CACHE_LINE_SIZE) PcoMutex mutex;
+    SparseStock misses;  // Quantités demandées mais non disponibles, par item (demande récente)
     int nbSupplied;  // Nombre total d'items fournis
-    static IWindowInterface* interface;  // Interface pour les logs et mises à jour
-    PcoMutex mutex;
+    int nbProduced;  // Nombre total d'items produits (salaires payés)
 };
 
 
@@ -92,9 +196,13 @@ public:
      * Initialise un fournisseur spécialisé dans les dispositifs médicaux.
      * @param uniqueId : ID du fournisseur
      * @param fund : Argent initial disponible pour ce fournisseur
+     * @param windowInterface : Interface propre à ce fournisseur
+     * @param nbProducers : Nombre de producteurs
      */
-    MedicalDeviceSupplier(int uniqueId, int fund)
-        : Supplier(uniqueId, fund, {ItemType::Scalpel, ItemType::Thermometer, ItemType::Stethoscope}) {
+    MedicalDeviceSupplier(int uniqueId, int fund, IWindowInterface* windowInterface, int nbProducers = 1)
+        : Supplier(uniqueId, fund,
+                   withRegistered({ItemType::Scalpel, ItemType::Thermometer, ItemType::Stethoscope}, SupplierKind::MedicalDevice),
+                   windowInterface, nbProducers) {
         // Log de création spécifique à un fournisseur d'outils médicaux
         interface->consoleAppendText(uniqueId, QString("Medical Tool Supplier Created"));
     }
@@ -107,9 +215,12 @@ public:
      * Initialise un fournisseur spécialisé dans les articles de pharmacie.
      * @param uniqueId : ID du fournisseur
      * @param fund : Argent initial disponible pour ce fournisseur
+     * @param windowInterface : Interface propre à ce fournisseur
+     * @param nbProducers : Nombre de producteurs
      */
-    Pharmacy(int uniqueId, int fund)
-        : Supplier(uniqueId, fund, {ItemType::Syringe, ItemType::Pill}) {
+    Pharmacy(int uniqueId, int fund, IWindowInterface* windowInterface, int nbProducers = 1)
+        : Supplier(uniqueId, fund, withRegistered({ItemType::Syringe, ItemType::Pill}, SupplierKind::Pharmacy),
+                   windowInterface, nbProducers) {
         // Log de création spécifique à une pharmacie
         interface->consoleAppendText(uniqueId, QString("Pharmacy Created"));
     }
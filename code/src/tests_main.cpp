@@ -4,10 +4,36 @@
 #include "iwindowinterface.h"
 #include "fakeinterface.h"
 #include <pcosynchro/pcothread.h>
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
 #include <iostream>
 #include <vector>
 #include <random>
 #include "utils.h"
+#include "replay.h"
+#include "headlessinterface.h"
+#include "shard.h"
+#include <thread>
+#include <unistd.h>
+
+/**
+ * @brief runBriefly
+ * Fait tourner une simulation complète pendant durationUs, l'arrête et vérifie que les patients sont conservés.
+ * @param finalReport Reçoit le rapport final si non nul
+ * @return Le bilan de la simulation
+ */
+SimulationStats runBriefly(const SimulationConfig& config, unsigned durationUs = 100000, QString* finalReport = nullptr) {
+    HeadlessInterface headless(10);
+    Utils utils(config, &headless);
+    PcoThread::usleep(durationUs);
+    utils.externalEndService();
+    EXPECT_EQ(utils.getStats().expectedPatients, utils.getStats().finalPatients);
+    if (finalReport) {
+        *finalReport = utils.getFinalReport();
+    }
+    return utils.getStats();
+}
 
 void sendPatients(Hospital& hospital, ItemType itemType, std::atomic<int>& totalPaid) {
     int tot = 0;
@@ -65,9 +91,8 @@ TEST(TestSuppliers, MedicalDeviceSupplierTest) {
     std::atomic<int> totalGained = 0;
 
     IWindowInterface* windowInterface = new FakeInterface();
-    Supplier::setInterface(windowInterface);
 
-    MedicalDeviceSupplier medicalDeviceSupplier(uniqueId, initialFund);
+    MedicalDeviceSupplier medicalDeviceSupplier(uniqueId, initialFund, windowInterface);
 
     std::vector<ItemType> items = { ItemType::Scalpel, ItemType::Thermometer, ItemType::Stethoscope };
 
@@ -99,9 +124,8 @@ TEST(TestSuppliers, PharmacyTest) {
     std::atomic<int> totalGained = 0;
 
     IWindowInterface* windowInterface = new FakeInterface();
-    Supplier::setInterface(windowInterface);
 
-    Pharmacy pharmacy(uniqueId, initialFund);
+    Pharmacy pharmacy(uniqueId, initialFund, windowInterface);
 
     std::vector<ItemType> items = { ItemType::Syringe, ItemType::Pill };
 
@@ -134,9 +158,8 @@ TEST(SellerTest, TestHospitals) {
     std::atomic<int> totalGained = 0;
 
     IWindowInterface* windowInterface = new FakeInterface();
-    Hospital::setInterface(windowInterface);
 
-    Hospital hospital(uniqueId, initialFund, maxBeds);
+    Hospital hospital(uniqueId, initialFund, maxBeds, windowInterface);
 
     std::vector<std::unique_ptr<PcoThread>> threads;
 
@@ -159,6 +182,829 @@ TEST(SellerTest, TestHospitals) {
     EXPECT_LE(hospital.getNumberPatients(), maxBeds);
 }
 
+class TestPharmacy : public Pharmacy {
+public:
+    using Pharmacy::Pharmacy;
+    using Pharmacy::chooseItemToProduce;
+    using Pharmacy::produce;
+};
+
+TEST(TestSuppliers, RestockFollowsDemand) {
+    const int initialFund = 20000;
+
+    IWindowInterface* windowInterface = new FakeInterface();
+
+    TestPharmacy pharmacy(0, initialFund, windowInterface);
+
+    // Les pilules manquent : elles doivent être produites en priorité
+    EXPECT_EQ(pharmacy.request(ItemType::Pill, 3), 0);
+    EXPECT_EQ(pharmacy.chooseItemToProduce(), ItemType::Pill);
+
+    PcoThread thread(&Supplier::run, &pharmacy);
+    PcoThread::usleep(20000);
+    thread.requestStop();
+    thread.join();
+
+    auto stocks = pharmacy.getItemsForSale();
+    EXPECT_GE(stocks[ItemType::Pill], SUPPLIER_LOW_WATERMARK);
+    EXPECT_LE(stocks[ItemType::Pill], SUPPLIER_HIGH_WATERMARK);
+    EXPECT_LE(stocks[ItemType::Syringe], SUPPLIER_HIGH_WATERMARK);
+    EXPECT_EQ(pharmacy.getFund() + pharmacy.getAmountPaidToWorkers(), initialFund);
+}
+
+/**
+ * @brief Interface dont simulateWork bloque jusqu'à ce que le test relâche les producteurs
+ */
+class GatedWorkInterface : public FakeInterface {
+public:
+    void simulateWork() override {
+        ++working;
+        while (!released) {
+            PcoThread::usleep(100);
+        }
+    }
+
+    std::atomic<int> working{0};
+    std::atomic<bool> released{false};
+};
+
+TEST(TestSuppliers, ProducersWorkOutsideTheLock) {
+    GatedWorkInterface interface;
+    TestPharmacy pharmacy(0, 20000, &interface, 4);
+
+    // Quatre producteurs en même temps : les lots en cours comptent dans le stock prévu
+    std::vector<std::unique_ptr<PcoThread>> producers;
+    for (int i = 0; i < 4; ++i) {
+        producers.emplace_back(std::make_unique<PcoThread>([&pharmacy]() { pharmacy.produce(); }));
+    }
+
+    // Un premier producteur bloqué dans son travail ne doit pas empêcher un second de réserver son lot
+    for (int i = 0; i < 1000 && interface.working < 2; ++i) {
+        PcoThread::usleep(1000);
+    }
+    EXPECT_GE(interface.working, 2);
+
+    interface.released = true;
+    for (auto& producer : producers) {
+        producer->join();
+    }
+    auto stocks = pharmacy.getItemsForSale();
+    EXPECT_EQ(stocks[ItemType::Pill] + stocks[ItemType::Syringe], pharmacy.getQuantityProduced());
+    EXPECT_LE(stocks[ItemType::Pill], SUPPLIER_HIGH_WATERMARK);
+    EXPECT_EQ(pharmacy.request(ItemType::Pill, stocks[ItemType::Pill]), stocks[ItemType::Pill] * PILL_COST);
+}
+
+class TestAmbulance : public Ambulance {
+public:
+    using Ambulance::Ambulance;
+    using Ambulance::sendPatient;
+};
+
+TEST(SellerTest, TestAmbulanceSkipsFullHospitals) {
+    const int nbPatients = 50;
+
+    IWindowInterface* windowInterface = new FakeInterface();
+
+    Hospital full(0, 20000, 1, windowInterface);
+    Hospital spare(1, 20000, nbPatients, windowInterface);
+    // Remplit le seul lit du premier hôpital
+    ASSERT_GT(full.send(ItemType::PatientSick, 1, getCostPerUnit(ItemType::PatientSick)), 0);
+    EXPECT_EQ(full.getFreeBedsHint(), 0);
+
+    std::vector<Seller*> hospitals = {&full, &spare};
+    for (HospitalSelection policy : {HospitalSelection::PowerOfTwoChoices,
+                                     HospitalSelection::LeastLoaded,
+                                     HospitalSelection::RoundRobin}) {
+        TestAmbulance ambulance(2, 0, {ItemType::PatientSick}, {{ItemType::PatientSick, 1}}, windowInterface);
+        ambulance.setHospitals(hospitals);
+        ambulance.setHospitalSelection(policy);
+
+        ambulance.sendPatient();
+
+        EXPECT_EQ(ambulance.getRejectedAdmissions(), 0);
+        EXPECT_EQ(ambulance.getNumberPatients(), 0);
+    }
+    EXPECT_EQ(spare.getFreeBedsHint(), nbPatients - 3);
+
+    // Hôpital sans indication (distant, en partitions) : il n'est pas compté comme plein
+    struct ProxyHospital : public Seller {
+        Hospital& target;
+        ProxyHospital(Hospital& target, IWindowInterface* windowInterface)
+            : Seller(0, 3, windowInterface), target(target) {}
+        std::map<ItemType, int> getItemsForSale() override { return target.getItemsForSale(); }
+        int send(ItemType what, int qty, int bill) override { return target.send(what, qty, bill); }
+        int request(ItemType what, int qty) override { return target.request(what, qty); }
+    };
+    ProxyHospital remote(spare, windowInterface);
+    std::vector<Seller*> withRemote = {&full, &remote};
+    for (HospitalSelection policy : {HospitalSelection::PowerOfTwoChoices, HospitalSelection::LeastLoaded}) {
+        TestAmbulance ambulance(2, 0, {ItemType::PatientSick}, {{ItemType::PatientSick, 1}}, windowInterface);
+        ambulance.setHospitals(withRemote);
+        ambulance.setHospitalSelection(policy);
+
+        ambulance.sendPatient();
+
+        EXPECT_EQ(ambulance.getNumberPatients(), 0);
+    }
+    EXPECT_EQ(spare.getFreeBedsHint(), nbPatients - 5);
+}
+
+void churnPatientPool(PatientPool& pool, std::atomic<int>& errors) {
+    for (int i = 0; i < 20000; ++i) {
+        PatientRecord* record = pool.acquire();
+        if (!record) {
+            continue;
+        }
+        // Une fiche ne doit jamais être donnée à deux threads en même temps
+        if (record->timestamps[0] != -1) {
+            errors++;
+        }
+        record->stamp(PatientStage::Ambulance);
+        record->timestamps.fill(-1);
+        pool.release(record);
+    }
+}
+
+TEST(CatalogTest, CatalogIsFoldedAtCompileTime) {
+    static_assert(getCostPerUnit(ItemType::Pill) == PILL_COST, "Coût lu dans le catalogue à la compilation");
+    static_assert(getEmployeeSalary(getEmployeeThatProduces(ItemType::PatientHealed)) == DOCTOR_COST,
+                  "Salaire du producteur lu dans le catalogue à la compilation");
+    static_assert(getCostPerUnit(ItemType::Nothing) == 0, "Nothing ne coûte rien");
+
+    // Noms construits une seule fois : deux appels renvoient la même chaîne
+    EXPECT_EQ(getItemName(ItemType::PatientSick), QString("Patient Sick"));
+    EXPECT_EQ(&getItemName(ItemType::Stethoscope), &getItemName(ItemType::Stethoscope));
+}
+
+// Nouvelle spécialité déclarée en une ligne ; la sous-classe de test expose le stock et les opérations générées
+template<ItemType... Needed>
+class TestClinic : public SpecializedClinic<Needed...> {
+public:
+    using SpecializedClinic<Needed...>::SpecializedClinic;
+    using SpecializedClinic<Needed...>::hasResources;
+    using SpecializedClinic<Needed...>::consumeResources;
+    using SpecializedClinic<Needed...>::treatPatients;
+    using SpecializedClinic<Needed...>::assembleKits;
+    using SpecializedClinic<Needed...>::claimKit;
+    using SpecializedClinic<Needed...>::returnKits;
+
+    void stock(ItemType item, int qty) { this->flatStock[itemIndex(item)] = qty; }
+    int stock(ItemType item) const { return this->flatStock[itemIndex(item)]; }
+};
+
+TEST(ClinicTest, SpecializedClinicUsesItsItemList) {
+    FakeInterface interface;
+    TestClinic<ItemType::PatientSick, ItemType::Syringe> dermatology(0, CLINICS_FUND, &interface);
+
+    EXPECT_FALSE(dermatology.hasResources());
+    dermatology.stock(ItemType::PatientSick, 2);
+    EXPECT_FALSE(dermatology.hasResources());
+    dermatology.stock(ItemType::Syringe, 1);
+    dermatology.stock(ItemType::Pill, 5);
+    EXPECT_TRUE(dermatology.hasResources());
+
+    // Seuls les items de la liste sont consommés
+    dermatology.consumeResources(1);
+    EXPECT_EQ(dermatology.stock(ItemType::PatientSick), 1);
+    EXPECT_EQ(dermatology.stock(ItemType::Syringe), 0);
+    EXPECT_EQ(dermatology.stock(ItemType::Pill), 5);
+    EXPECT_FALSE(dermatology.hasResources());
+
+    // Les spécialités existantes sont des instances du même modèle, avec leurs ressources propres
+    Pulmonology pulmonology(1, CLINICS_FUND, &interface);
+    std::map<ItemType, int> items = pulmonology.getItemsForSale();
+    EXPECT_EQ(items.count(ItemType::Pill), 1u);
+    EXPECT_EQ(items.count(ItemType::Thermometer), 1u);
+    EXPECT_EQ(items.count(ItemType::Syringe), 0u);
+}
+
+TEST(ClinicTest, DoctorsTreatInBatches) {
+    FakeInterface interface;
+    TestClinic<ItemType::PatientSick, ItemType::Pill> alone(0, CLINICS_FUND, &interface);
+    TestClinic<ItemType::PatientSick, ItemType::Pill> team(1, CLINICS_FUND, &interface, 4);
+    for (auto* clinic : {&alone, &team}) {
+        clinic->stock(ItemType::PatientSick, 10);
+        clinic->stock(ItemType::Pill, 6);
+    }
+
+    // Un traitement soigne un patient par médecin, dans la limite du stock
+    EXPECT_EQ(alone.treatPatients(), 1);
+    EXPECT_EQ(team.treatPatients(), 4);
+    EXPECT_EQ(team.treatPatients(), 2);
+    EXPECT_EQ(team.treatPatients(), 0);
+    EXPECT_EQ(team.stock(ItemType::PatientHealed), 6);
+    EXPECT_EQ(team.getHealedHint(), 6);
+    EXPECT_EQ(team.stock(ItemType::PatientSick), 4);
+    EXPECT_EQ(team.getFund(), CLINICS_FUND - 6 * DOCTOR_COST);
+    EXPECT_EQ(team.getAmountPaidToWorkers(), 6 * DOCTOR_COST);
+
+    // Les hôpitaux lisent les patients soignés sans verrou : l'indication suit les ventes
+    EXPECT_EQ(team.request(ItemType::PatientHealed, 2), 2 * getCostPerUnit(ItemType::PatientHealed));
+    EXPECT_EQ(team.getHealedHint(), 4);
+
+    // ... et des fonds : un salaire par patient soigné
+    TestClinic<ItemType::PatientSick, ItemType::Pill> poor(2, 2 * DOCTOR_COST + 1, &interface, 4);
+    poor.stock(ItemType::PatientSick, 10);
+    poor.stock(ItemType::Pill, 10);
+    EXPECT_EQ(poor.treatPatients(), 2);
+    EXPECT_EQ(poor.treatPatients(), 0);
+}
+
+TEST(ClinicTest, DoctorsShareKitsWithoutLock) {
+    FakeInterface interface;
+    TestClinic<ItemType::PatientSick, ItemType::Pill> clinic(0, CLINICS_FUND, &interface, 4);
+    clinic.stock(ItemType::PatientSick, 10);
+    clinic.stock(ItemType::Pill, 10);
+
+    // Un kit d'avance par médecin, ressources et salaires réservés
+    EXPECT_EQ(clinic.assembleKits(), 4);
+    EXPECT_EQ(clinic.assembleKits(), 0);
+    EXPECT_EQ(clinic.stock(ItemType::Pill), 6);
+    EXPECT_EQ(clinic.getFund(), CLINICS_FUND - 4 * DOCTOR_COST);
+
+    // Huit médecins se disputent les quatre kits : chacun est réclamé une seule fois
+    std::atomic<int> claimed = 0;
+    std::vector<std::unique_ptr<PcoThread>> doctors;
+    for (int i = 0; i < 8; ++i) {
+        doctors.emplace_back(std::make_unique<PcoThread>([&clinic, &claimed]() {
+            if (clinic.claimKit()) {
+                claimed++;
+            }
+        }));
+    }
+    for (auto& doctor : doctors) {
+        doctor->join();
+    }
+    EXPECT_EQ(claimed, 4);
+
+    // Les kits non réclamés à l'arrêt sont rendus : seuls les patients soignés sont payés
+    EXPECT_EQ(clinic.assembleKits(), 4);
+    EXPECT_TRUE(clinic.claimKit());
+    EXPECT_EQ(clinic.returnKits(), 3);
+    EXPECT_EQ(clinic.stock(ItemType::Pill), 2 + 3);
+    EXPECT_EQ(clinic.getFund(), CLINICS_FUND - 5 * DOCTOR_COST);
+}
+
+TEST(RegistryTest, LoadedItemsAreSuppliedAndSparse) {
+    const QString path = "items_test.txt";
+    const int nbLoaded = 300;
+    {
+        std::ofstream file(path.toStdString());
+        file << "# nom;coût;fournisseur\n";
+        for (int i = 0; i < nbLoaded; ++i) {
+            file << "Consumable " << i << ";" << 1 + i % 7 << ";" << (i % 2 ? "devices" : "pharmacy") << "\n";
+        }
+    }
+
+    // Un fichier invalide n'ajoute rien, y compris pour un coût suivi d'autres caractères
+    for (const char* bad : {"Gauze;3;pharmacy\nBandage;cheap;pharmacy\n", "Gauze;12abc;pharmacy\n"}) {
+        {
+            std::ofstream file("items_bad.txt");
+            file << bad;
+        }
+        EXPECT_FALSE(ItemRegistry::load("items_bad.txt"));
+        EXPECT_EQ(ItemRegistry::size(), ITEM_CATALOG.size());
+    }
+
+    // Fin de ligne CRLF et blancs autour des champs : retirés
+    {
+        std::ofstream file("items_bad.txt");
+        file << "Gauze ; 3 ; pharmacy\r\n";
+    }
+    ASSERT_TRUE(ItemRegistry::load("items_bad.txt"));
+    EXPECT_EQ(getItemName(ItemRegistry::find("Gauze")), QString("Gauze"));
+    EXPECT_EQ(getCostPerUnit(ItemRegistry::find("Gauze")), 3);
+
+    // Gelé pendant la vie d'une simulation : ni chargement ni remise à zéro
+    ItemRegistry::freeze();
+    EXPECT_FALSE(ItemRegistry::load(path));
+    ItemRegistry::reset();
+    EXPECT_NE(ItemRegistry::find("Gauze"), ItemType::Nothing);
+    ItemRegistry::thaw();
+    ItemRegistry::reset();
+
+    ASSERT_TRUE(ItemRegistry::load(path));
+    ASSERT_EQ(ItemRegistry::size(), ITEM_CATALOG.size() + nbLoaded);
+
+    // Identifiants denses à la suite du catalogue, coût et nom lus dans le registre
+    ItemType last = ItemRegistry::find("Consumable 299");
+    EXPECT_EQ(itemIndex(last), ITEM_CATALOG.size() + nbLoaded - 1);
+    EXPECT_EQ(getCostPerUnit(last), 1 + 299 % 7);
+    EXPECT_EQ(getItemName(last), QString("Consumable 299"));
+    EXPECT_EQ(getCostPerUnit(ItemType::Pill), PILL_COST);
+    EXPECT_EQ(ItemRegistry::suppliedBy(SupplierKind::Pharmacy).count(), std::size_t(nbLoaded / 2));
+
+    ItemSet set{ItemType::Pill, last};
+    EXPECT_TRUE(set.contains(last));
+    EXPECT_FALSE(set.contains(ItemType::Syringe));
+    EXPECT_EQ(set.items(), std::vector<ItemType>({ItemType::Pill, last}));
+
+    SparseStock stock;
+    stock[last] = 3;
+    stock[ItemType::Pill] = 1;
+    EXPECT_EQ(stock.size(), 2u);
+    EXPECT_EQ(stock.get(ItemType::Syringe), 0);
+    EXPECT_EQ(stock.begin()->first, ItemType::Pill);
+
+    // La pharmacie vend ses items intégrés et les consommables chargés pour elle, et refuse les autres
+    FakeInterface interface;
+    TestPharmacy pharmacy(0, SUPPLIER_FUND, &interface);
+    ItemType gauze = ItemRegistry::find("Consumable 0");
+    EXPECT_TRUE(pharmacy.carries(gauze));
+    EXPECT_TRUE(pharmacy.carries(ItemType::Pill));
+    EXPECT_FALSE(pharmacy.carries(ItemRegistry::find("Consumable 1")));
+    EXPECT_EQ(pharmacy.getItemsForSale().size(), std::size_t(2 + nbLoaded / 2));
+    EXPECT_EQ(pharmacy.request(ItemRegistry::find("Consumable 1"), 1), 0);
+
+    // Une demande manquée fait produire le consommable, après les items intégrés sous le seuil bas ;
+    // seule la demande manquée est produite : les autres consommables ne vident pas la caisse
+    EXPECT_EQ(pharmacy.request(gauze, 1), 0);
+    EXPECT_EQ(pharmacy.chooseItemToProduce(), ItemType::Syringe);
+    while (pharmacy.produce()) {}
+    auto forSale = pharmacy.getItemsForSale();
+    EXPECT_EQ(forSale[gauze], 1);
+    EXPECT_EQ(forSale[ItemRegistry::find("Consumable 2")], 0);
+    EXPECT_GE(forSale[ItemType::Pill], SUPPLIER_LOW_WATERMARK);
+    EXPECT_GE(forSale[ItemType::Syringe], SUPPLIER_LOW_WATERMARK);
+
+    ItemRegistry::reset();
+    std::remove(path.toStdString().c_str());
+    std::remove("items_bad.txt");
+    EXPECT_EQ(ItemRegistry::size(), ITEM_CATALOG.size());
+}
+
+TEST(PatientTrackingTest, PoolAndQueue) {
+    const size_t capacity = 8;
+    PatientPool pool(capacity);
+
+    PatientQueue queue;
+    for (size_t i = 0; i < capacity; ++i) {
+        PatientRecord* record = pool.acquire();
+        ASSERT_NE(record, nullptr);
+        queue.push(record);
+    }
+    EXPECT_EQ(pool.acquire(), nullptr);
+    EXPECT_EQ(queue.size(), capacity);
+
+    PatientRecord* first = queue.pop();
+    EXPECT_EQ(first->id, 0u);
+    pool.release(first);
+    while (PatientRecord* record = queue.pop()) {
+        pool.release(record);
+    }
+    EXPECT_TRUE(queue.empty());
+
+    std::atomic<int> errors = 0;
+    std::vector<std::unique_ptr<PcoThread>> threads;
+    for (int i = 0; i < 4; ++i) {
+        threads.emplace_back(std::make_unique<PcoThread>(churnPatientPool, std::ref(pool), std::ref(errors)));
+    }
+    for (auto& thread : threads) {
+        thread->join();
+    }
+    EXPECT_EQ(errors, 0);
+
+    for (size_t i = 0; i < capacity; ++i) {
+        EXPECT_NE(pool.acquire(), nullptr);
+    }
+    EXPECT_EQ(pool.acquire(), nullptr);
+}
+
+TEST(PatientTrackingTest, LatencyHistogramPrecision) {
+    // Les intervalles se suivent sans trou ni chevauchement
+    for (int i = 1; i < LatencyHistogram::NB_BUCKETS; ++i) {
+        EXPECT_EQ(LatencyHistogram::lowestValueAt(i), LatencyHistogram::highestValueAt(i - 1) + 1);
+    }
+
+    LatencyHistogram histogram;
+    for (std::int64_t value = 1; value <= 100000; ++value) {
+        EXPECT_LE(LatencyHistogram::lowestValueAt(LatencyHistogram::indexOf(value)), value);
+        EXPECT_GE(LatencyHistogram::highestValueAt(LatencyHistogram::indexOf(value)), value);
+        histogram.record(value);
+    }
+    histogram.record(-1);
+
+    EXPECT_EQ(histogram.getCount(), 100000u);
+    EXPECT_EQ(histogram.getMax(), 100000);
+    for (double percentile : {50.0, 90.0, 99.0}) {
+        double expected = percentile * 1000;
+        EXPECT_NEAR(histogram.valueAtPercentile(percentile), expected, expected / LatencyHistogram::SUB_BUCKETS);
+    }
+}
+
+TEST(SweepTest, IndependentSimulationsInOneProcess) {
+    // Deux simulations simultanées, chacune avec sa propre interface, sa propre configuration et son propre suivi
+    SimulationConfig small;
+    small.bedsPerHospital = 5;
+    small.trackPatients = true;
+    SimulationConfig large = small;
+    large.bedsPerHospital = 50;
+    large.hospitalFund = 2 * HOSPITALS_FUND;
+
+    HeadlessInterface smallInterface(10), largeInterface(10);
+    Utils smallRun(small, &smallInterface);
+    Utils largeRun(large, &largeInterface);
+    PcoThread::usleep(100000);
+    smallRun.externalEndService();
+    largeRun.externalEndService();
+
+    EXPECT_GT(smallInterface.getNbMessages(), 0u);
+    EXPECT_GT(largeInterface.getNbMessages(), 0u);
+
+    EXPECT_EQ(smallRun.getStats().expectedPatients, smallRun.getStats().finalPatients);
+    EXPECT_EQ(largeRun.getStats().expectedPatients, largeRun.getStats().finalPatients);
+    EXPECT_EQ(largeRun.getStats().expectedFund - smallRun.getStats().expectedFund, NB_HOSPITALS * HOSPITALS_FUND);
+    EXPECT_TRUE(smallRun.getFinalReport().contains("Patient latency"));
+    EXPECT_TRUE(largeRun.getFinalReport().contains("Patient latency"));
+}
+
+TEST(PlacementTest, ClusteringKeepsPartnersTogether) {
+    // Deux hôpitaux, chacun avec ses deux cliniques et son fournisseur : deux îlots reliés par un seul lien
+    ActorPlacement placement(8, 2);
+    placement.addLink(0, 1);
+    placement.addLink(0, 2);
+    placement.addLink(0, 3);
+    placement.addLink(4, 5);
+    placement.addLink(4, 6);
+    placement.addLink(4, 7);
+    placement.addLink(3, 7);
+
+    std::vector<int> layout = placement.clustered();
+    EXPECT_EQ(placement.crossGroupLinks(layout), 1);
+    EXPECT_GT(placement.crossGroupLinks(placement.spread()), 1);
+    EXPECT_EQ(std::count(layout.begin(), layout.end(), 0), 4);
+}
+
+TEST(LayoutTest, SellersDoNotShareCacheLines) {
+    EXPECT_EQ(alignof(Supplier) % CACHE_LINE_SIZE, 0u);
+    EXPECT_EQ(sizeof(Supplier) % CACHE_LINE_SIZE, 0u);
+    EXPECT_EQ(sizeof(Hospital) % CACHE_LINE_SIZE, 0u);
+    EXPECT_EQ(sizeof(Clinic) % CACHE_LINE_SIZE, 0u);
+
+    // Fournisseurs alloués à la suite, comme dans createSuppliers : aucun ne commence au milieu d'une ligne
+    SimulationConfig config;
+    config.nbSuppliers = 9;
+    FakeInterface interface;
+    SimulationArena arena;
+    std::vector<Supplier*> suppliers = createSuppliers(config, 0, &interface, arena);
+    for (Supplier* supplier : suppliers) {
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(supplier) % CACHE_LINE_SIZE, 0u);
+    }
+}
+
+TEST(ArenaTest, EntitiesAndLinksAreContiguous) {
+    // Compte les destructions pour vérifier que l'arène libère tout, dans l'ordre inverse de création
+    static std::vector<int> destroyed;
+    struct Tracked {
+        int id;
+        explicit Tracked(int id) : id(id) {}
+        ~Tracked() { destroyed.push_back(id); }
+    };
+
+    FakeInterface interface;
+    {
+        SimulationArena arena;
+        Tracked* first = arena.create<Tracked>(1);
+        arena.create<Tracked>(2);
+        EXPECT_EQ(first->id, 1);
+
+        Hospital* a = arena.create<Hospital>(0, HOSPITALS_FUND, 2, &interface);
+        Hospital* b = arena.create<Hospital>(1, HOSPITALS_FUND, 2, &interface);
+        EXPECT_EQ(reinterpret_cast<char*>(b) - reinterpret_cast<char*>(a), std::ptrdiff_t(sizeof(Hospital)));
+        EXPECT_EQ(reinterpret_cast<std::uintptr_t>(a) % CACHE_LINE_SIZE, 0u);
+        EXPECT_GE(arena.getBytesUsed(), 2 * sizeof(Hospital));
+
+        // Deux lignes bout à bout dans la table ; une ligne peut être partagée par plusieurs entités
+        LinkTable links;
+        int both = links.addRow({a, b});
+        int onlyB = links.addRow({b});
+        EXPECT_EQ(links.getNbLinks(), 3u);
+        ASSERT_EQ(links.row(both).size(), 2u);
+        EXPECT_EQ(links.row(both)[1], b);
+        EXPECT_EQ(links.row(onlyB)[0], b);
+        EXPECT_EQ(links.row(both).end(), links.row(onlyB).begin());
+    }
+    EXPECT_EQ(destroyed, std::vector<int>({2, 1}));
+}
+
+TEST(MailboxTest, OrdersAreServedByTheSellerThread) {
+    // Plusieurs producteurs, un consommateur : rien n'est perdu et chaque producteur garde son ordre
+    struct Message : MpscNode {
+        int producer = 0;
+        int sequence = 0;
+    };
+    const int nbProducers = 4;
+    const int nbMessages = 5000;
+    std::vector<Message> messages(nbProducers * nbMessages);
+    MpscQueue<Message> queue;
+
+    std::vector<std::unique_ptr<PcoThread>> producers;
+    for (int p = 0; p < nbProducers; ++p) {
+        producers.emplace_back(std::make_unique<PcoThread>([&messages, &queue, p]() {
+            for (int i = 0; i < nbMessages; ++i) {
+                Message& message = messages[p * nbMessages + i];
+                message.producer = p;
+                message.sequence = i;
+                queue.push(&message);
+            }
+        }));
+    }
+    std::vector<int> next(nbProducers, 0);
+    int received = 0;
+    int errors = 0;
+    while (received < nbProducers * nbMessages) {
+        if (Message* message = queue.pop()) {
+            errors += message->sequence != next[message->producer]++;
+            ++received;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+    for (auto& producer : producers) {
+        producer->join();
+    }
+    EXPECT_EQ(errors, 0);
+    EXPECT_EQ(queue.pop(), nullptr);
+}
+
+/**
+ * @brief Interface dont chaque attente simulée dure une seconde
+ */
+class SlowWorkInterface : public FakeInterface {
+public:
+    unsigned workDuration() override { return 1000000; }
+};
+
+class TestHospital : public Hospital {
+public:
+    using Hospital::Hospital;
+    using Seller::workServingOrders;
+};
+
+TEST(MailboxTest, OrdersWakeAWorkingSeller) {
+    SlowWorkInterface interface;
+    TestHospital hospital(0, HOSPITALS_FUND, 2, &interface);
+    hospital.enableInbox();
+
+    // Le vendeur est dans son attente simulée : l'ordre est traité avant qu'elle ne se termine
+    std::atomic<bool> workDone{false};
+    PcoThread seller([&hospital, &workDone]() {
+        hospital.workServingOrders();
+        workDone = true;
+    });
+    int bill = getCostPerUnit(ItemType::PatientSick);
+    Order order(OrderKind::Send, ItemType::PatientSick, 1, bill);
+    std::future<int> reply = hospital.post(order);
+    EXPECT_EQ(reply.get(), bill);
+    EXPECT_FALSE(workDone);
+    seller.join();
+    EXPECT_EQ(hospital.getNumberPatients(), 1);
+}
+
+#ifdef HAS_COROUTINE_ACTORS
+TEST(CoroutineTest, ManyLightweightActors) {
+    // Cent mille acteurs sur quatre threads : chacun attend trois fois, sans occuper de thread pendant l'attente
+    const int nbActors = 100000;
+    std::atomic<int> steps{0};
+    std::size_t framesBefore = ActorScheduler::getFrameBytes();
+    std::size_t bytesPerActor = 0;
+    {
+        ActorScheduler scheduler(4);
+        for (int i = 0; i < nbActors; ++i) {
+            scheduler.spawn([](ActorScheduler& scheduler, std::atomic<int>& steps) -> ActorTask {
+                for (int j = 0; j < 3; ++j) {
+                    co_await scheduler.sleep(100);
+                    steps.fetch_add(1, std::memory_order_relaxed);
+                }
+            }(scheduler, steps));
+        }
+        bytesPerActor = (ActorScheduler::getFrameBytes() - framesBefore) / nbActors;
+        scheduler.start();
+        scheduler.wait();
+        EXPECT_EQ(scheduler.getNbActors(), 0u);
+    }
+    EXPECT_EQ(steps.load(), 3 * nbActors);
+    EXPECT_LT(bytesPerActor, 1024u);
+    EXPECT_EQ(ActorScheduler::getFrameBytes(), framesBefore);
+}
+#endif
+
+/**
+ * @brief Variante de simulation complète : une configuration et, si non nul, un nombre de consommables à charger
+ */
+struct SimulationCase {
+    const char* name;
+    SimulationConfig config;
+    int nbLoadedItems = 0;
+};
+
+void PrintTo(const SimulationCase& simulationCase, std::ostream* os) {
+    *os << simulationCase.name;
+}
+
+std::vector<SimulationCase> simulationCases() {
+    std::vector<SimulationCase> cases;
+    SimulationConfig base;
+
+    cases.push_back({"Default", base});
+
+    SimulationConfig batches = base;
+    batches.doctorsPerClinic = 4;
+    cases.push_back({"Batches", batches});
+
+    SimulationConfig doctors = batches;
+    doctors.doctorThreads = true;
+    cases.push_back({"Doctors", doctors});
+
+    SimulationConfig clustered = base;
+    clustered.placement = PlacementMode::Clustered;
+    clustered.placementGroups = 2;
+    cases.push_back({"Clustered", clustered});
+
+    SimulationConfig mailboxes = base;
+    mailboxes.mailboxes = true;
+    cases.push_back({"Mailboxes", mailboxes});
+
+#ifdef HAS_COROUTINE_ACTORS
+    SimulationConfig coroutines = base;
+    coroutines.coroutines = true;
+    coroutines.doctorsPerClinic = 2;
+    coroutines.producersPerSupplier = 2;
+    cases.push_back({"Coroutines", coroutines});
+
+    SimulationConfig coroutineDoctors = coroutines;
+    coroutineDoctors.doctorThreads = true;
+    cases.push_back({"CoroutineDoctors", coroutineDoctors});
+#endif
+
+    cases.push_back({"LoadedItems", base, 300});
+    return cases;
+}
+
+class SimulationTest : public ::testing::TestWithParam<SimulationCase> {};
+
+TEST_P(SimulationTest, PatientsAreConservedAndDischarged) {
+    const SimulationCase& simulationCase = GetParam();
+    const QString path = "items_simulation.txt";
+    if (simulationCase.nbLoadedItems) {
+        {
+            std::ofstream file(path.toStdString());
+            for (int i = 0; i < simulationCase.nbLoadedItems; ++i) {
+                file << "Consumable " << i << ";" << 1 + i % 7 << ";" << (i % 2 ? "devices" : "pharmacy") << "\n";
+            }
+        }
+        ASSERT_TRUE(ItemRegistry::load(path));
+    }
+
+    // Deux simulations successives : chaque Utils libère ses entités à sa destruction
+    for (int run = 0; run < 2; ++run) {
+        QString report;
+        SimulationStats stats = runBriefly(simulationCase.config, 100000, &report);
+        EXPECT_GT(stats.dischargedPatients, 0);
+        if (simulationCase.config.placement != PlacementMode::None) {
+            EXPECT_GT(stats.crossGroupLinks, 0);
+            EXPECT_TRUE(report.contains("cross-group calls"));
+        }
+    }
+
+    if (simulationCase.nbLoadedItems) {
+        ItemRegistry::reset();
+        std::remove(path.toStdString().c_str());
+    }
+}
+
+INSTANTIATE_TEST_SUITE_P(Modes, SimulationTest, ::testing::ValuesIn(simulationCases()),
+                         [](const ::testing::TestParamInfo<SimulationCase>& info) { return std::string(info.param.name); });
+
+TEST(ShardTest, RingTransfersInOrder) {
+    using Ring = ShmRing<int, 8>;
+    ShmSegment segment("/pco_hospital_ring_test_" + std::to_string(getpid()), Ring::bytes());
+    ASSERT_TRUE(segment.isValid());
+
+    const int nbValues = 20000;
+    std::atomic<int> errors = 0;
+    PcoThread producer([&]() {
+        Ring ring(segment.data());
+        for (int i = 0; i < nbValues; ++i) {
+            while (!ring.tryPush(i)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    PcoThread consumer([&]() {
+        Ring ring(segment.data());
+        for (int i = 0; i < nbValues; ++i) {
+            int value;
+            while (!ring.tryPop(value)) {
+                std::this_thread::yield();
+            }
+            if (value != i) {
+                errors++;
+            }
+        }
+    });
+    producer.join();
+    consumer.join();
+    EXPECT_EQ(errors, 0);
+}
+
+TEST(ShardTest, ShardsConservePatients) {
+    // Les partitions tournent ici dans des threads du même processus ; le protocole est celui des processus séparés
+    const int nbShards = 2;
+    SimulationConfig config;
+    config.trackPatients = false;
+
+    ShmSegment segment("/pco_hospital_shard_test_" + std::to_string(getpid()), Shard::sharedMemorySize(config, nbShards));
+    ASSERT_TRUE(segment.isValid());
+    ShardControl* control = new (segment.data()) ShardControl();
+
+    std::vector<std::unique_ptr<HeadlessInterface>> interfaces;
+    std::vector<std::unique_ptr<PcoThread>> shards;
+    for (int k = 0; k < nbShards; ++k) {
+        interfaces.emplace_back(std::make_unique<HeadlessInterface>(10));
+        HeadlessInterface* windowInterface = interfaces.back().get();
+        shards.emplace_back(std::make_unique<PcoThread>([&config, &segment, windowInterface, k]() {
+            Shard shard(config, k, nbShards, segment.data(), windowInterface);
+            shard.run();
+        }));
+    }
+    PcoThread::usleep(200000);
+    control->stop = true;
+    for (auto& shard : shards) {
+        shard->join();
+    }
+
+    int patients = 0;
+    long remoteCalls = 0;
+    for (int k = 0; k < nbShards; ++k) {
+        patients += control->results[k].patients;
+        remoteCalls += control->results[k].remoteCalls;
+    }
+    EXPECT_EQ(patients, config.initialPatientsSick * ((config.nbSuppliers + 2) / 3));
+    EXPECT_GT(remoteCalls, 0);
+}
+
+TEST(ShardTest, StartIsAbandonedWhenAShardIsMissing) {
+    // La seconde partition ne démarre jamais : la première doit quitter la barrière à la demande d'arrêt
+    SimulationConfig config;
+    config.trackPatients = false;
+
+    ShmSegment segment("/pco_hospital_shard_abandon_" + std::to_string(getpid()), Shard::sharedMemorySize(config, 2));
+    ASSERT_TRUE(segment.isValid());
+    ShardControl* control = new (segment.data()) ShardControl();
+
+    HeadlessInterface headless(10);
+    bool started = true;
+    PcoThread shardThread([&]() {
+        Shard shard(config, 0, 2, segment.data(), &headless);
+        started = shard.run();
+    });
+    PcoThread::usleep(20000);
+    control->stop = true;
+    shardThread.join();
+
+    EXPECT_FALSE(started);
+    EXPECT_EQ(control->actorsDone.load(), 0);
+}
+
+std::string reportWithoutLatencies(Utils& utils) {
+    // Les latences dépendent de l'horloge : seuls les bilans (avant le nombre d'itérations) doivent être identiques
+    std::string report = utils.getFinalReport().toStdString();
+    return report.substr(0, report.rfind('\n', report.find(" steps : ")));
+}
+
+TEST(ReplayTest, ReplayReproducesRecordedRun) {
+    const QString path = "replay_test.bin";
+
+    // Interface sûre entre threads, sans attente simulée : tous les acteurs l'appellent en même temps
+    HeadlessInterface headless(0);
+    IWindowInterface* windowInterface = &headless;
+
+    std::string recorded;
+    {
+        Utils utils(SimulationConfig(), windowInterface, QString(), Replay::record(path));
+
+        // Une autre simulation du processus, arrêtée avant : elle n'interrompt ni ne termine l'enregistrement
+        HeadlessInterface otherInterface(0);
+        {
+            Utils other(SimulationConfig(), &otherInterface);
+            PcoThread::usleep(20000);
+            other.externalEndService();
+        }
+        PcoThread::usleep(30000);
+        utils.externalEndService();
+        recorded = reportWithoutLatencies(utils);
+    }
+
+    std::unique_ptr<Replay> replay = Replay::load(path);
+    ASSERT_TRUE(replay);
+    Utils utils(SimulationConfig(), windowInterface, QString(), std::move(replay));
+    utils.waitEndOfService();
+
+    EXPECT_EQ(reportWithoutLatencies(utils), recorded);
+    std::remove(path.toStdString().c_str());
+}
+
 int main(int argc, char **argv) {
     ::testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();
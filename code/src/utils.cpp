@@ -5,15 +5,68 @@ void Utils::endService() {
     for (auto& thread : threads) {
         thread->requestStop();
     }
+#ifdef HAS_COROUTINE_ACTORS
+    if (scheduler) {
+        scheduler->requestStop();
+    }
+#endif
+    if (replay) {
+        replay->abort();
+    }
 }
 
 void Utils::externalEndService() {
     endService();
+    waitEndOfService();
+}
+
+void Utils::waitEndOfService() {
     semEnd.acquire();
     utilsThread->join();
+    serviceEnded = true;
 }
 
-std::vector<Ambulance*> createAmbulances(int nbAmbulances, int idStart){
+Utils::~Utils() {
+    // Les entités vivent dans l'arène : leurs threads doivent être arrêtés avant qu'elle ne soit libérée
+    if (!serviceEnded) {
+        externalEndService();
+    }
+    ItemRegistry::thaw();
+}
+
+Seller* createActor(const SimulationConfig& config, int id, IWindowInterface* windowInterface, SimulationArena& arena) {
+    // Même numérotation partout : ambulances et fournisseurs, puis hôpitaux, puis cliniques
+    if (id < config.nbSuppliers) {
+        switch (id % 3) {
+            case 0: {
+                std::map<ItemType, int> initialAmbulanceStock = {{ItemType::PatientSick, config.initialPatientsSick}};
+                return arena.create<Ambulance>(id, config.supplierFund, std::vector<ItemType>{ItemType::PatientSick},
+                                               initialAmbulanceStock, windowInterface);
+            }
+            case 1:
+                return arena.create<MedicalDeviceSupplier>(id, config.supplierFund, windowInterface, config.producersPerSupplier);
+            default:
+                return arena.create<Pharmacy>(id, config.supplierFund, windowInterface, config.producersPerSupplier);
+        }
+    }
+
+    int hospital = id - config.nbSuppliers;
+    if (hospital < config.nbHospitals) {
+        return arena.create<Hospital>(id, config.hospitalFund, config.bedsPerHospital, windowInterface);
+    }
+
+    switch ((hospital - config.nbHospitals) % 3) {
+        case 0:
+            return arena.create<Pulmonology>(id, config.clinicFund, windowInterface, config.doctorsPerClinic);
+        case 1:
+            return arena.create<Cardiology>(id, config.clinicFund, windowInterface, config.doctorsPerClinic);
+        default:
+            return arena.create<Neurology>(id, config.clinicFund, windowInterface, config.doctorsPerClinic);
+    }
+}
+
+std::vector<Ambulance*> createAmbulances(const SimulationConfig& config, int idStart, IWindowInterface* windowInterface, SimulationArena& arena){
+    int nbAmbulances = config.nbSuppliers;
     if (nbAmbulances < 1){
         qInfo() << "Cannot make the programm work with less than 1 Supplier";
         exit(-1);
@@ -22,19 +75,15 @@ std::vector<Ambulance*> createAmbulances(int nbAmbulances, int idStart){
     std::vector<Ambulance*> ambulances;
 
     for(int i = 0; i < nbAmbulances; ++i){
-        switch(i % 3) {
-
-            case 0:{
-                std::map<ItemType, int> initialAmbulanceStock = {{ItemType::PatientSick, INITIAL_PATIENT_SICK}};
-                ambulances.push_back(new Ambulance(i + idStart, SUPPLIER_FUND, {ItemType::PatientSick}, initialAmbulanceStock));
-                break;
-            }
+        if (i % 3 == 0) {
+            ambulances.push_back(static_cast<Ambulance*>(createActor(config, i + idStart, windowInterface, arena)));
         }
     }
     return ambulances;
 }
 
-std::vector<Supplier*> createSuppliers(int nbSuppliers, int idStart) {
+std::vector<Supplier*> createSuppliers(const SimulationConfig& config, int idStart, IWindowInterface* windowInterface, SimulationArena& arena) {
+    int nbSuppliers = config.nbSuppliers;
     if (nbSuppliers < 1){
         qInfo() << "Cannot make the programm work with less than 1 Supplier";
         exit(-1);
@@ -43,21 +92,15 @@ std::vector<Supplier*> createSuppliers(int nbSuppliers, int idStart) {
     std::vector<Supplier*> suppliers;
 
     for(int i = 0; i < nbSuppliers; ++i){
-        switch(i % 3) {
-            case 1:{
-                suppliers.push_back(new MedicalDeviceSupplier(i + idStart, SUPPLIER_FUND));
-                break;
-            }
-            case 2:{
-                suppliers.push_back(new Pharmacy(i + idStart, SUPPLIER_FUND));
-                break;
-            }
+        if (i % 3 != 0) {
+            suppliers.push_back(static_cast<Supplier*>(createActor(config, i + idStart, windowInterface, arena)));
         }
     }
     return suppliers;
 }
 
-std::vector<Clinic*> createClinics(int nbClinics, int idStart) {
+std::vector<Clinic*> createClinics(const SimulationConfig& config, int idStart, IWindowInterface* windowInterface, SimulationArena& arena) {
+    int nbClinics = config.nbClinics;
     if (nbClinics < 1){
         qInfo() << "Cannot make the programm work with less than 1 Clinic";
         exit(-1);
@@ -66,26 +109,15 @@ std::vector<Clinic*> createClinics(int nbClinics, int idStart) {
     std::vector<Clinic*> clinics;
 
     for(int i = 0; i < nbClinics; ++i) {
-        switch(i % 3) {
-            case 0:
-                clinics.push_back(new Pulmonology(i + idStart, CLINICS_FUND));
-                break;
-
-            case 1:
-                clinics.push_back(new Cardiology(i + idStart, CLINICS_FUND));
-                break;
-
-            case 2:
-                clinics.push_back(new Neurology(i + idStart, CLINICS_FUND));
-                break;
-        }
+        clinics.push_back(static_cast<Clinic*>(createActor(config, i + idStart, windowInterface, arena)));
     }
 
 
     return clinics;
 }
 
-std::vector<Hospital*> createHospitals(int nbHospital, int idStart) {
+std::vector<Hospital*> createHospitals(const SimulationConfig& config, int idStart, IWindowInterface* windowInterface, SimulationArena& arena) {
+    int nbHospital = config.nbHospitals;
     if(nbHospital < 1){
         qInfo() << "Cannot launch the programm without any hospitalr";
         exit(-1);
@@ -93,14 +125,52 @@ std::vector<Hospital*> createHospitals(int nbHospital, int idStart) {
     std::vector<Hospital*> hospitals;
 
     for(int i = 0; i < nbHospital; ++i){
-        hospitals.push_back(new Hospital(i + idStart, HOSPITALS_FUND, MAX_BEDS_PER_HOSTPITAL));
+        hospitals.push_back(static_cast<Hospital*>(createActor(config, i + idStart, windowInterface, arena)));
     }
 
     return hospitals;
 }
 
+// Cliniques de l'hôpital h (indices parmi les cliniques) : un bloc propre, plus les cliniques partagées par tous
+static std::vector<int> clinicsOfHospital(const SimulationConfig& config, int h) {
+    int clinicsByHospital = config.nbClinics / config.nbHospitals;
+    int clinicsShared = config.nbClinics % config.nbHospitals;
 
-Utils::Utils(int nbSupplier, int nbClinic, int nbHospital) {
+    std::vector<int> indices;
+    for (int c = h * clinicsByHospital; c < (h + 1) * clinicsByHospital; ++c) {
+        indices.push_back(c);
+    }
+    for (int c = config.nbClinics - clinicsShared; c < config.nbClinics; ++c) {
+        indices.push_back(c);
+    }
+    return indices;
+}
+
+
+static SimulationConfig defaultConfig(int nbSupplier, int nbClinic, int nbHospital) {
+    SimulationConfig config;
+    config.nbSuppliers = nbSupplier;
+    config.nbClinics = nbClinic;
+    config.nbHospitals = nbHospital;
+    return config;
+}
+
+Utils::Utils(int nbSupplier, int nbClinic, int nbHospital, IWindowInterface* windowInterface, QString latencyCsvPath)
+    : Utils(defaultConfig(nbSupplier, nbClinic, nbHospital), windowInterface, latencyCsvPath) {}
+
+Utils::Utils(const SimulationConfig& config, IWindowInterface* windowInterface, QString latencyCsvPath,
+             std::unique_ptr<Replay> replayLog)
+    : replay(std::move(replayLog)),
+      config(config),
+      topology(config.placement == PlacementMode::None ? CpuTopology() : CpuTopology::detect(config.placementGroups)),
+      placement(config.nbSuppliers + config.nbClinics + config.nbHospitals, int(topology.groups.size())),
+      latencyCsvPath(latencyCsvPath) {
+    // Les acteurs lisent le registre sans verrou : il ne change plus tant que la simulation existe
+    ItemRegistry::freeze();
+
+    int nbSupplier = config.nbSuppliers;
+    int nbClinic = config.nbClinics;
+    int nbHospital = config.nbHospitals;
     int nbAmbulances = nbSupplier / 3;
     if (nbSupplier % 3 != 0) {
         nbAmbulances += 1;
@@ -110,109 +180,365 @@ Utils::Utils(int nbSupplier, int nbClinic, int nbHospital) {
     this->hospitals.resize(nbHospital);
     this->clinics.resize(nbClinic);
 
-    this->ambulances = createAmbulances(nbSupplier, 0);
-    this->suppliers = createSuppliers(nbSupplier, 0);
-    this->hospitals = createHospitals(nbHospital, nbSupplier);
-    this->clinics = createClinics(nbClinic, nbSupplier + nbHospital);
+    if (config.trackPatients) {
+        tracker = std::make_unique<PatientTracker>(size_t(config.initialPatientsSick) * nbAmbulances);
+    }
 
-    int clinicsByHospital = nbClinic / nbHospital;
-    int clinicsShared = nbClinic % nbHospital;
+    // Le graphe des liens ne dépend que des identifiants : la disposition est connue avant la construction,
+    // chaque acteur peut alors être construit sur le nœud de son groupe de cœurs
+    declareLinks();
+    placeActors();
+
+    if (layout.empty()) {
+        this->ambulances = createAmbulances(config, 0, windowInterface, arena);
+        this->suppliers = createSuppliers(config, 0, windowInterface, arena);
+        this->hospitals = createHospitals(config, nbSupplier, windowInterface, arena);
+        this->clinics = createClinics(config, nbSupplier + nbHospital, windowInterface, arena);
+    } else {
+        createPlacedActors(windowInterface);
+    }
 
-    int countSupplier = 0;
-    int countClinic = 0;
+    std::vector<Seller*> tmpHospitals(hospitals.begin(), hospitals.end());
+    std::vector<Seller*> tmpSuppliers(suppliers.begin(), suppliers.end());
+
+    // Toutes les listes de liens dans une seule table : les ambulances et les cliniques partagent
+    // les lignes des hôpitaux et des fournisseurs, chaque hôpital a la ligne de ses cliniques
+    int hospitalsRow = links.addRow(tmpHospitals);
+    int suppliersRow = links.addRow(tmpSuppliers);
+    std::vector<int> clinicsRows;
+    for (int h = 0; h < nbHospital; ++h) {
+        std::vector<Seller*> tmpClinics;
+        for (int c : clinicsOfHospital(config, h)) {
+            tmpClinics.push_back(clinics[c]);
+        }
+        clinicsRows.push_back(links.addRow(tmpClinics));
+    }
 
-    std::vector<Seller*> tmpHospitals;
-    std::vector<Seller*> tmpSuppliers;
-    std::vector<Seller*> tmpClinics;
-    
     // Préparation des hopitaux, ils ont besoin des clincs
-    for(auto& h : hospitals) {
-        std::vector<Seller*> tmpClinics(clinics.begin() + countClinic, clinics.begin() + countClinic + clinicsByHospital);
-        tmpClinics.insert(tmpClinics.end(), clinics.end() - clinicsShared, clinics.end());
-
-        countClinic += clinicsByHospital;
-        
-        h->setClinics(tmpClinics);
-        tmpHospitals.push_back(static_cast<Seller*>(h));
+    for (size_t h = 0; h < hospitals.size(); ++h) {
+        hospitals[h]->setClinics(links.row(clinicsRows[h]));
     }
 
     // Préparation des ambulances, ils ont besoin des hôpitaux
     for(auto& a : ambulances){
-        a->setHospitals(tmpHospitals);
-    }
-
-    for(auto& s : suppliers){
-        tmpSuppliers.push_back(static_cast<Seller*>(s));
+        a->setHospitals(links.row(hospitalsRow));
     }
 
     // Préparation des clincs, qui ont besoin des hôpitaux et des suppliers
     for(auto& c : clinics) {
-        c->setHospitalsAndSuppliers(tmpHospitals, tmpSuppliers);
+        c->setHospitalsAndSuppliers(links.row(hospitalsRow), links.row(suppliersRow));
+    }
+
+    // Enregistrement ou rejeu propre à cette simulation : graines et ordre des itérations de ses seuls acteurs
+    if (replay) {
+        for (Ambulance* ambulance : ambulances) {
+            ambulance->setReplay(replay.get());
+        }
+        for (Supplier* supplier : suppliers) {
+            supplier->setReplay(replay.get());
+        }
+        for (Hospital* hospital : hospitals) {
+            hospital->setReplay(replay.get());
+        }
+        for (Clinic* clinic : clinics) {
+            clinic->setReplay(replay.get());
+        }
+    }
+
+    // Les fiches des patients circulent entre ambulances, hôpitaux et cliniques de cette simulation seulement
+    if (tracker) {
+        for (Ambulance* ambulance : ambulances) {
+            ambulance->setPatientTracker(tracker.get());
+        }
+        for (Hospital* hospital : hospitals) {
+            hospital->setPatientTracker(tracker.get());
+        }
+        for (Clinic* clinic : clinics) {
+            clinic->setPatientTracker(tracker.get());
+        }
+    }
+
+    // Coroutines : les acteurs partagent un pool de threads. Les épingler n'a plus de sens, et les boîtes aux lettres
+    // bloqueraient les threads du pool en attendant les réponses : les échanges restent des appels directs
+    // Sans support des coroutines, les acteurs ont chacun leur thread et gardent leurs boîtes aux lettres
+    bool coroutines = false;
+#ifdef HAS_COROUTINE_ACTORS
+    coroutines = config.coroutines && config.placement == PlacementMode::None && !replay;
+    if (coroutines) {
+        scheduler = std::make_unique<ActorScheduler>(config.coroutineThreads);
+    }
+#else
+    if (config.coroutines) {
+        qWarning() << "Coroutine actors need a C++20 build (PCO_COROUTINES), running one thread per actor";
+    }
+#endif
+
+    // Pendant un enregistrement ou un rejeu, les traitements restent dans la routine des cliniques : ordre total
+    if (config.doctorThreads && !replay) {
+        for (Clinic* clinic : clinics) {
+            clinic->enableDoctorThreads();
+        }
+    }
+
+    // Les vendeurs appelés traitent eux-mêmes les ordres : aucun verrou n'est pris depuis le thread d'un autre acteur
+    if (config.mailboxes && !coroutines && !replay) {
+        for (Seller* seller : tmpHospitals) {
+            seller->enableInbox();
+        }
+        for (Seller* seller : tmpSuppliers) {
+            seller->enableInbox();
+        }
+        for (Clinic* clinic : clinics) {
+            clinic->enableInbox();
+        }
     }
 
+    startActors();
     utilsThread = std::make_unique<PcoThread>(&Utils::run, this);
 }
 
-void Utils::run() {
+void Utils::declareLinks() {
+    if (config.placement == PlacementMode::None) {
+        return;
+    }
+
+    // Mêmes liens que les listes distribuées par le constructeur, déclarés par identifiant
+    int hospitalStart = config.nbSuppliers;
+    int clinicStart = config.nbSuppliers + config.nbHospitals;
+    for (int h = 0; h < config.nbHospitals; ++h) {
+        for (int c : clinicsOfHospital(config, h)) {
+            placement.addLink(hospitalStart + h, clinicStart + c);
+        }
+    }
+    for (int id = 0; id < config.nbSuppliers; ++id) {
+        for (int h = 0; h < config.nbHospitals; ++h) {
+            if (id % 3 == 0) {
+                placement.addLink(id, hospitalStart + h);
+            }
+        }
+        for (int c = 0; c < config.nbClinics; ++c) {
+            if (id % 3 != 0) {
+                placement.addLink(clinicStart + c, id);
+            }
+        }
+    }
+    for (int c = 0; c < config.nbClinics; ++c) {
+        for (int h = 0; h < config.nbHospitals; ++h) {
+            placement.addLink(clinicStart + c, hospitalStart + h);
+        }
+    }
+}
+
+void Utils::createPlacedActors(IWindowInterface* windowInterface) {
+    int nbActors = config.nbSuppliers + config.nbHospitals + config.nbClinics;
+    std::vector<Seller*> actors(nbActors, nullptr);
+
+    // Chaque groupe construit ses acteurs dans sa propre arène, depuis un thread épinglé sur ses cœurs : les blocs
+    // de l'arène et les allocations des constructeurs (stocks, listes) sont touchés en premier depuis le nœud local,
+    // où le noyau place alors leurs pages
+    for (std::size_t g = 0; g < topology.groups.size(); ++g) {
+        groupArenas.push_back(std::make_unique<SimulationArena>());
+    }
+    std::vector<std::unique_ptr<PcoThread>> builders;
+    for (int g = 0; g < int(topology.groups.size()); ++g) {
+        builders.emplace_back(std::make_unique<PcoThread>([this, g, &actors, windowInterface]() {
+            if (!ActorPlacement::pinCurrentThread(topology.groups[g], g)) {
+                qWarning() << "Could not pin the builder of core group" << g;
+            }
+            for (std::size_t id = 0; id < actors.size(); ++id) {
+                if (layout[id] == g) {
+                    actors[id] = createActor(config, int(id), windowInterface, *groupArenas[g]);
+                }
+            }
+        }));
+    }
+    for (auto& builder : builders) {
+        builder->join();
+    }
+
+    ambulances.clear();
+    suppliers.clear();
+    hospitals.clear();
+    clinics.clear();
+    for (int id = 0; id < nbActors; ++id) {
+        if (id < config.nbSuppliers) {
+            if (id % 3 == 0) {
+                ambulances.push_back(static_cast<Ambulance*>(actors[id]));
+            } else {
+                suppliers.push_back(static_cast<Supplier*>(actors[id]));
+            }
+        } else if (id < config.nbSuppliers + config.nbHospitals) {
+            hospitals.push_back(static_cast<Hospital*>(actors[id]));
+        } else {
+            clinics.push_back(static_cast<Clinic*>(actors[id]));
+        }
+    }
+}
+
+void Utils::placeActors() {
+    switch (config.placement) {
+        case PlacementMode::None:
+            return;
+        case PlacementMode::Spread:
+            layout = placement.spread();
+            break;
+        case PlacementMode::Clustered:
+            layout = placement.clustered();
+            break;
+    }
+    stats.crossGroupLinks = placement.crossGroupLinks(layout);
+}
+
+template<typename Actor>
+void Utils::startActor(Actor* actor) {
+    if (layout.empty()) {
+        threads.emplace_back(std::make_unique<PcoThread>(&Actor::run, actor));
+        return;
+    }
+
+    int group = layout[actor->getUniqueId()];
+    std::vector<int> cpus = topology.groups[group];
+    actor->setPlacementGroup(group);
+
+    // L'épinglage se fait depuis le thread de l'acteur, avant sa boucle : ses allocations suivantes
+    // sont alors servies par le nœud local
+    threads.emplace_back(std::make_unique<PcoThread>([actor, cpus, group]() {
+        if (!ActorPlacement::pinCurrentThread(cpus, group)) {
+            qWarning() << "Could not pin actor" << actor->getUniqueId() << "to core group" << group;
+        }
+        actor->run();
+    }));
+}
+
+void Utils::startActors() {
+#ifdef HAS_COROUTINE_ACTORS
+    if (scheduler) {
+        for (Ambulance* ambulance : ambulances) {
+            scheduler->spawn(ambulance->runTask(*scheduler));
+        }
+        for (Supplier* supplier : suppliers) {
+            scheduler->spawn(supplier->runTask(*scheduler));
+        }
+        for (Clinic* clinic : clinics) {
+            scheduler->spawn(clinic->runTask(*scheduler));
+        }
+        for (Hospital* hospital : hospitals) {
+            scheduler->spawn(hospital->runTask(*scheduler));
+        }
+        scheduler->start();
+        return;
+    }
+#endif
 
     for(size_t i = 0; i < ambulances.size(); ++i) {
-        threads.emplace_back(std::make_unique<PcoThread>(&Ambulance::run, ambulances[i]));
+        startActor(ambulances[i]);
     }
 
     for(size_t i = 0; i < suppliers.size(); ++i) {
-        threads.emplace_back(std::make_unique<PcoThread>(&Supplier::run, suppliers[i]));
+        startActor(suppliers[i]);
     }
 
     for(size_t i = 0; i < clinics.size(); ++i) {
-        threads.emplace_back(std::make_unique<PcoThread>(&Clinic::run, clinics[i]));
+        startActor(clinics[i]);
     }
 
     for(size_t i = 0; i < hospitals.size(); ++i) {
-        threads.emplace_back(std::make_unique<PcoThread>(&Hospital::run, hospitals[i]));
+        startActor(hospitals[i]);
     }
+}
 
+void Utils::run() {
+#ifdef HAS_COROUTINE_ACTORS
+    if (scheduler) {
+        scheduler->wait();
+    }
+#endif
     for (auto& thread : threads) {
         thread->join();
     }
+
+    bool replaying = replay && replay->isReplaying();
+    size_t nbSteps = replay ? replay->getStepCount() : 0;
+    if (replay && !replay->finish()) {
+        qWarning() << "Could not write the replay log";
+    }
     
-    int startPatient = INITIAL_PATIENT_SICK * ambulances.size();
+    int startPatient = config.initialPatientsSick * ambulances.size();
 
     int endPatient = 0;
 
 
 
-    int startFund = (SUPPLIER_FUND * int(ambulances.size())) +
-                    (SUPPLIER_FUND * int(suppliers.size())) +
-                    (CLINICS_FUND * int(clinics.size())) +
-                    (HOSPITALS_FUND * int(hospitals.size()));
+    int startFund = (config.supplierFund * int(ambulances.size())) +
+                    (config.supplierFund * int(suppliers.size())) +
+                    (config.clinicFund * int(clinics.size())) +
+                    (config.hospitalFund * int(hospitals.size()));
 
     int endFund = 0;
 
+    int rejectedAdmissions = 0;
+
+    int discharged = 0;
+
+    int crossGroupCalls = 0;
+
     for (Ambulance* ambulance: ambulances) {
         endFund += ambulance->getFund();
         endFund += ambulance->getAmountPaidToWorkers();
         endPatient += ambulance->getNumberPatients();
+        rejectedAdmissions += ambulance->getRejectedAdmissions();
     }
 
     for (Supplier* supplier: suppliers) {
         endFund += supplier->getFund();
         endFund += supplier->getAmountPaidToWorkers();
+        crossGroupCalls += supplier->getCrossGroupCalls();
     }
 
     for (Clinic* clinic: clinics) {
         endFund += clinic->getFund();
         endFund += clinic->getAmountPaidToWorkers();
         endPatient += clinic->getNumberPatients();
+        crossGroupCalls += clinic->getCrossGroupCalls();
     }
 
     for (Hospital* hospital: hospitals) {
         endFund += hospital->getFund();
         endFund += hospital->getAmountPaidToWorkers();
         endPatient += hospital->getNumberPatients();
+        discharged += hospital->getDischargedPatients();
+        crossGroupCalls += hospital->getCrossGroupCalls();
     }
 
+    stats.expectedFund = startFund;
+    stats.finalFund = endFund;
+    stats.expectedPatients = startPatient;
+    stats.finalPatients = endPatient;
+    stats.dischargedPatients = discharged;
+    stats.rejectedAdmissions = rejectedAdmissions;
+    stats.crossGroupCalls = crossGroupCalls;
+
     finalReport = QString("The expected fund is : %1 and you got at the end : %2\n").arg(startFund).arg(endFund);
-    finalReport += QString("The expected patient is : %1 and you got at the end : %2").arg(startPatient).arg(endPatient);
+    finalReport += QString("The expected patient is : %1 and you got at the end : %2\n").arg(startPatient).arg(endPatient);
+    finalReport += QString("Admissions rejected by hospitals : %1").arg(rejectedAdmissions);
+    if (nbSteps) {
+        finalReport += QString("\n%1 steps : %2").arg(replaying ? "Replayed" : "Recorded").arg(nbSteps);
+    }
+    if (!layout.empty()) {
+        finalReport += QString("\nPlacement %1 on %2 core groups : %3/%4 cross-group links (spread : %5), %6 cross-group calls")
+                           .arg(ActorPlacement::modeName(config.placement))
+                           .arg(placement.getNbGroups())
+                           .arg(stats.crossGroupLinks)
+                           .arg(placement.getNbLinks())
+                           .arg(placement.crossGroupLinks(placement.spread()))
+                           .arg(crossGroupCalls);
+    }
+    if (tracker) {
+        finalReport += "\n" + tracker->report();
+        if (!latencyCsvPath.isEmpty() && !tracker->exportCsv(latencyCsvPath)) {
+            qWarning() << "Could not write latency histograms to" << latencyCsvPath;
+        }
+    }
 
     qInfo() << "The expected fund is : " << startFund << " and you got at the end : " << endFund;
     semEnd.release();
@@ -222,3 +548,19 @@ QString Utils::getFinalReport()
 {
     return finalReport;
 }
+
+SimulationStats Utils::getStats() const
+{
+    return stats;
+}
+
+double Utils::getBedOccupancy() const
+{
+    int totalBeds = 0;
+    int freeBeds = 0;
+    for (const Hospital* hospital : hospitals) {
+        totalBeds += hospital->getMaxBeds();
+        freeBeds += hospital->getFreeBedsHint();
+    }
+    return totalBeds ? double(totalBeds - freeBeds) / totalBeds : 0.0;
+}
@@ -17,4 +17,4 @@ then
 fi
 
 echo "The following files are archived in $ARCHIVE : "
-tar --exclude='rendu.tar.gz' --exclude='*.o' --exclude='*.user' -czvf $ARCHIVE code/src code/ui code/images $REPORT_FILE
+tar --exclude='rendu.tar.gz' --exclude='*.o' --exclude='*.user' -czvf $ARCHIVE code/src code/ui code/images code/images.qrc $REPORT_FILE